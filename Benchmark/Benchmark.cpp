@@ -0,0 +1,250 @@
+/*
+Benchmark.cpp
+Micro-benchmarks of the simulation and mesh generation hot paths
+C++
+Needs no window or GL context, results are printed and optionally written
+as JSON to compare runs across releases
+*/
+
+//  C++ headers
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+//  stb_image for the texture decoding, the same decoder Texture::LoadTexture uses
+#include <SOIL/stb_image.h>
+
+//  Custom headers
+#include "BenchmarkRunner.h"
+#include "ParticleEmitter.h"
+#include "ProceduralMesh.h"
+#include "Profiler.h"
+#include "Simulation.h"
+#include "ThreadPool.h"
+
+//  Written by every benchmark so the compiler cannot drop the work being timed
+volatile float benchmarkSink = 0.0f;
+
+//  Particle counts of the AddForce benchmarks
+const int PARTICLE_COUNTS[] = { 1024, 16384, 131072 };
+
+//  Ball positions of the collision benchmarks, inside the box and near its walls
+const int COLLISION_POSITIONS = 1024;
+
+void BenchmarkAddForce(BenchmarkRunner& runner, ThreadPool* pool);
+void BenchmarkCollision(BenchmarkRunner& runner);
+void BenchmarkProceduralMesh(BenchmarkRunner& runner);
+void BenchmarkImageDecode(BenchmarkRunner& runner, const char* path);
+void BenchmarkProfileZone(BenchmarkRunner& runner);
+
+int main(int argc, char** argv) {
+
+    //  Command line
+    //  --json FILE     write the results to FILE as JSON
+    //  --warmup N      untimed rounds before the samples of every benchmark
+    //  --samples N     timed samples of every benchmark
+    //  --filter NAME   only run the benchmarks whose name contains NAME
+    //  --threads N     threads of the particle update, 1 updates serially and 0 uses one per core
+    //  --image FILE    image decoded by the texture benchmark
+    const char* jsonPath = NULL;
+    int warmup = 3;
+    int samples = 30;
+    const char* filter = "";
+    int threadCount = 1;
+    const char* imagePath = "../Bouncer/images/tiles.jpg";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+            warmup = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc)
+            samples = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threadCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--image") == 0 && i + 1 < argc)
+            imagePath = argv[++i];
+        else
+            std::cout << "Ignoring unknown argument " << argv[i] << std::endl;
+    }
+
+    BenchmarkRunner runner(warmup, samples);
+    runner.SetFilter(filter);
+
+    ThreadPool pool(threadCount);
+    BenchmarkAddForce(runner, threadCount == 1 ? NULL : &pool);
+    BenchmarkCollision(runner);
+    BenchmarkProceduralMesh(runner);
+    BenchmarkImageDecode(runner, imagePath);
+    BenchmarkProfileZone(runner);
+
+    if (jsonPath != NULL && !runner.WriteJson(jsonPath))
+        return 1;
+    return 0;
+}
+
+/*
+    One ParticleEmitter::AddForce step under gravity for every particle count
+    The emitter is filled with a burst of particles that live through the
+    whole benchmark and emission is off, so every step updates them all.
+*/
+void BenchmarkAddForce(BenchmarkRunner& runner, ThreadPool* pool) {
+    const glm::vec3 gravity(0.0f, -9.8f, 0.0f);
+    const int sizes = sizeof(PARTICLE_COUNTS) / sizeof(PARTICLE_COUNTS[0]);
+
+    for (int s = 0; s < sizes; s++) {
+        int count = PARTICLE_COUNTS[s];
+        ParticleEmitter emitter(count, glm::vec3(0.0f), glm::vec3(5.0f, 10.0f, 0.0f), 2.0f, 1.0e6f, 0.0f);
+        emitter.SetThreadPool(pool);
+        emitter.SetEmissionRate(0.0f);
+        emitter.SetSeed(1);
+        emitter.Burst(count);
+
+        //  about a million particle updates per sample
+        int operations = std::max(1, (1 << 20) / count);
+        runner.Run("AddForce/" + std::to_string(count), operations, [&]() {
+            emitter.AddForce(gravity);
+        }, count);
+        benchmarkSink = emitter.GetParticles().m_y[0];
+    }
+}
+
+/*
+    CollisionCheck, FindDistance and CollisionResponse of the single ball
+    against the walls of the box, each over a fixed set of positions
+*/
+void BenchmarkCollision(BenchmarkRunner& runner) {
+    ConfigurePlanes();
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> coordinate(-15.0f, 15.0f);
+    std::uniform_int_distribution<int> plane(0, GetWalls().GetPlaneCount() - 1);
+    std::vector<glm::vec3> positions(COLLISION_POSITIONS);
+    std::vector<glm::vec3> velocities(COLLISION_POSITIONS);
+    std::vector<int> planes(COLLISION_POSITIONS);
+    for (int i = 0; i < COLLISION_POSITIONS; i++) {
+        positions[i] = glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));
+        velocities[i] = glm::vec3(coordinate(rng), coordinate(rng), coordinate(rng));
+        planes[i] = plane(rng);
+    }
+
+    runner.Run("CollisionCheck", 64, [&]() {
+        int hits = 0;
+        for (int i = 0; i < COLLISION_POSITIONS; i++)
+            hits += CollisionCheck(positions[i]) ? 1 : 0;
+        benchmarkSink = (float)hits;
+    }, COLLISION_POSITIONS);
+
+    runner.Run("FindDistance", 64, [&]() {
+        float sum = 0.0f;
+        for (int i = 0; i < COLLISION_POSITIONS; i++)
+            sum += FindDistance(positions[i]);
+        benchmarkSink = sum;
+    }, COLLISION_POSITIONS);
+
+    runner.Run("CollisionResponse", 64, [&]() {
+        glm::vec3 sum(0.0f);
+        for (int i = 0; i < COLLISION_POSITIONS; i++)
+            sum += CollisionResponse(velocities[i], planes[i]);
+        benchmarkSink = sum.x + sum.y + sum.z;
+    }, COLLISION_POSITIONS);
+}
+
+/*
+    Generation of the procedural meshes, no upload
+    The mesh is reused between rounds as it would be when rebuilding a level
+    of detail, so its buffers are only allocated in the first round. Items
+    are vertices.
+*/
+void BenchmarkProceduralMesh(BenchmarkRunner& runner) {
+    MeshData mesh;
+
+    runner.Run("BuildUVSphere/64x64", 16, [&]() {
+        BuildUVSphere(mesh, 64, 64);
+        benchmarkSink = mesh.GetPosition(mesh.vertexCount / 2)[0];
+    }, 65 * 65);
+
+    runner.Run("BuildUVSphere/64x64/PackedNormal", 16, [&]() {
+        BuildUVSphere(mesh, 64, 64, VERTEX_PACKED_NORMAL);
+        benchmarkSink = mesh.GetPosition(mesh.vertexCount / 2)[0];
+    }, 65 * 65);
+
+    runner.Run("BuildIcosphere/4", 4, [&]() {
+        BuildIcosphere(mesh, 4);
+        benchmarkSink = mesh.GetPosition(mesh.vertexCount / 2)[0];
+    }, 2562);
+
+    runner.Run("BuildBox", 1024, [&]() {
+        BuildBox(mesh);
+        benchmarkSink = mesh.GetPosition(mesh.vertexCount / 2)[0];
+    }, 24);
+
+    runner.Run("BuildPlane/64x64", 16, [&]() {
+        BuildPlane(mesh, 64, 64);
+        benchmarkSink = mesh.GetPosition(mesh.vertexCount / 2)[0];
+    }, 65 * 65);
+
+    runner.Run("BuildCylinder/64", 256, [&]() {
+        BuildCylinder(mesh, 64);
+        benchmarkSink = mesh.GetPosition(mesh.vertexCount / 2)[0];
+    }, 2 * 65 + 2 * 66);
+
+    //  all levels of the ball sphere, 64 x 64 down to 8 x 8
+    std::vector<MeshData> lods;
+    runner.Run("BuildUVSphereLods/64/4", 16, [&]() {
+        BuildUVSphereLods(lods, 64, 4);
+        benchmarkSink = lods[0].GetPosition(lods[0].vertexCount / 2)[0];
+    }, 65 * 65 + 33 * 33 + 17 * 17 + 9 * 9);
+}
+
+/*
+    Decoding of a texture image from memory, as in Texture::LoadTexture
+    The file is read once up front so disk access is not part of the time.
+*/
+void BenchmarkImageDecode(BenchmarkRunner& runner, const char* path) {
+    std::string name = path;
+    name = "DecodeImage/" + name.substr(name.find_last_of("/\\") + 1);
+    if (!runner.IsSelected(name))
+        return;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cout << "Skipping the image benchmark, failed to open " << path << std::endl;
+        return;
+    }
+    std::vector<unsigned char> encoded((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    int width = 0, height = 0, channels = 0;
+    if (!stbi_info_from_memory(&encoded[0], (int)encoded.size(), &width, &height, &channels)) {
+        std::cout << "Skipping the image benchmark, failed to decode " << path << std::endl;
+        return;
+    }
+
+    runner.Run(name, 1, [&]() {
+        int w, h, c;
+        unsigned char* image = stbi_load_from_memory(&encoded[0], (int)encoded.size(), &w, &h, &c, 0);
+        benchmarkSink = image != NULL ? image[0] : 0.0f;
+        stbi_image_free(image);
+    }, (double)width * height);
+}
+
+/*
+    Cost of one profiler zone when zones are compiled in, see Profiler.h
+    The zone is used directly so this measures it whether or not this
+    project defines PROFILER_ENABLED.
+*/
+void BenchmarkProfileZone(BenchmarkRunner& runner) {
+    const int zones = 64;
+
+    runner.Run("ProfileZone", 16, [&]() {
+        for (int i = 0; i < zones; i++)
+            ProfileZone zone("BenchmarkProfileZone");
+    }, zones);
+}
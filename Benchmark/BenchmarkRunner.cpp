@@ -0,0 +1,128 @@
+//  Contains the member functions of BENCHMARK_RUNNER.H
+
+#include "BenchmarkRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+    //  Value below which the given fraction of the sorted samples lie, nearest rank
+    double Percentile(const std::vector<double>& sorted, double fraction)
+    {
+        int rank = (int)std::ceil(fraction * sorted.size()) - 1;
+        rank = std::max(0, std::min(rank, (int)sorted.size() - 1));
+        return sorted[rank];
+    }
+
+    //  Writes text as the contents of a JSON string, names can hold user
+    //  supplied parts such as the file name of the image benchmark
+    void WriteJsonString(std::ostream& out, const std::string& text)
+    {
+        const char* hex = "0123456789abcdef";
+        for (size_t i = 0; i < text.size(); i++) {
+            unsigned char c = (unsigned char)text[i];
+            if (c == '"' || c == '\\')
+                out << '\\' << (char)c;
+            else if (c < 0x20)
+                out << "\\u00" << hex[c >> 4] << hex[c & 0xF];
+            else
+                out << (char)c;
+        }
+    }
+}
+
+BenchmarkRunner::BenchmarkRunner(int warmup, int samples) :
+    m_warmup(std::max(0, warmup)), m_samples(std::max(1, samples))
+{
+}
+
+void BenchmarkRunner::SetFilter(const std::string& filter) {
+    m_filter = filter;
+}
+
+bool BenchmarkRunner::IsSelected(const std::string& name) const {
+    return m_filter.empty() || name.find(m_filter) != std::string::npos;
+}
+
+void BenchmarkRunner::Run(const std::string& name, int operations, const std::function<void()>& op, double items) {
+    if (!IsSelected(name))
+        return;
+    operations = std::max(1, operations);
+
+    //  caches, branch predictors and lazily built state settle during the warmup
+    for (int w = 0; w < m_warmup; w++)
+        for (int i = 0; i < operations; i++)
+            op();
+
+    std::vector<double> times(m_samples);
+    for (int s = 0; s < m_samples; s++) {
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < operations; i++)
+            op();
+        std::chrono::high_resolution_clock::time_point stop = std::chrono::high_resolution_clock::now();
+        times[s] = std::chrono::duration<double, std::nano>(stop - start).count() / operations;
+    }
+
+    BenchmarkResult result;
+    result.name = name;
+    result.operations = operations;
+    result.samples = m_samples;
+    result.mean = 0.0;
+    for (int s = 0; s < m_samples; s++)
+        result.mean += times[s];
+    result.mean /= m_samples;
+    std::sort(times.begin(), times.end());
+    result.median = Percentile(times, 0.5);
+    result.p95 = Percentile(times, 0.95);
+    result.min = times[0];
+    result.itemsPerOp = items;
+    m_results.push_back(result);
+
+    std::cout << std::left << std::setw(36) << name << std::right << std::fixed << std::setprecision(1)
+              << " median " << std::setw(12) << result.median << " ns"
+              << "   p95 " << std::setw(12) << result.p95 << " ns";
+    if (items != 1.0)
+        std::cout << "   " << std::setprecision(2) << std::setw(8) << result.median / items << " ns/item";
+    std::cout << std::defaultfloat << std::endl;
+}
+
+const std::vector<BenchmarkResult>& BenchmarkRunner::GetResults() const {
+    return m_results;
+}
+
+bool BenchmarkRunner::WriteJson(const char* path) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cout << "Failed to open benchmark output file " << path << std::endl;
+        return false;
+    }
+
+    file << std::setprecision(9);
+    file << "{\n";
+    file << "  \"warmup\": " << m_warmup << ",\n";
+    file << "  \"samples\": " << m_samples << ",\n";
+    file << "  \"unit\": \"ns\",\n";
+    file << "  \"benchmarks\": [";
+    for (size_t i = 0; i < m_results.size(); i++) {
+        const BenchmarkResult& r = m_results[i];
+        file << (i == 0 ? "\n" : ",\n");
+        file << "    { \"name\": \"";
+        WriteJsonString(file, r.name);
+        file << "\""
+             << ", \"operations\": " << r.operations
+             << ", \"samples\": " << r.samples
+             << ", \"median\": " << r.median
+             << ", \"p95\": " << r.p95
+             << ", \"min\": " << r.min
+             << ", \"mean\": " << r.mean
+             << ", \"items\": " << r.itemsPerOp
+             << ", \"median_per_item\": " << r.median / r.itemsPerOp << " }";
+    }
+    file << "\n  ]\n}\n";
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#ifndef BENCHMARK_RUNNER_H
+#define BENCHMARK_RUNNER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+//  Timing of one benchmark, all times in nanoseconds per operation
+struct BenchmarkResult
+{
+    std::string name;
+    int operations;         //  operations timed together in one sample
+    int samples;
+    double median;
+    double p95;
+    double min;
+    double mean;
+    double itemsPerOp;      //  particles, bodies, pixels... handled by one operation
+};
+
+/*
+    Times small pieces of code
+
+    Run calls the function a number of times as warmup, then takes samples
+    of several calls each. A sample holds enough calls to last well above
+    the clock resolution, the time of an operation is the sample divided
+    by the number of calls. The median and the 95th percentile of the
+    samples are reported, they are much less sensitive to the odd slow
+    sample from the OS than the mean.
+
+        BenchmarkRunner runner;
+        runner.Run("StepBall", 1000, [&]() { StepBall(pos, vel, h, g); });
+        runner.WriteJson("results.json");
+*/
+class BenchmarkRunner
+{
+public:
+    BenchmarkRunner(int warmup = 3, int samples = 30);
+
+    //  Only benchmarks whose name contains filter run, an empty filter runs all
+    void SetFilter(const std::string& filter);
+    bool IsSelected(const std::string& name) const;
+
+    //  Times op, each sample calls it operations times, items is the work done by one call
+    void Run(const std::string& name, int operations, const std::function<void()>& op, double items = 1.0);
+
+    const std::vector<BenchmarkResult>& GetResults() const;
+
+    //  Writes the results as JSON, returns false if the file cannot be opened
+    bool WriteJson(const char* path) const;
+
+private:
+    int m_warmup;
+    int m_samples;
+    std::string m_filter;
+    std::vector<BenchmarkResult> m_results;
+};
+
+#endif // !BENCHMARK_RUNNER_H
@@ -0,0 +1,132 @@
+//  Contains the member functions of BALL_SYSTEM.H
+
+#include "BallSystem.h"
+
+#include <cmath>
+
+BallSystem::BallSystem() :
+    m_walls(NULL), m_restitution(1.0f), m_friction(0.1f), m_contactCount(0)
+{
+}
+
+int BallSystem::AddBall(const glm::vec3& position, const glm::vec3& velocity, float radius) {
+    m_x.push_back(position.x);
+    m_y.push_back(position.y);
+    m_z.push_back(position.z);
+    m_vx.push_back(velocity.x);
+    m_vy.push_back(velocity.y);
+    m_vz.push_back(velocity.z);
+    m_prevX.push_back(position.x);
+    m_prevY.push_back(position.y);
+    m_prevZ.push_back(position.z);
+    m_radius.push_back(radius);
+
+    //  uniform density, mass = r^3 up to a constant that cancels out in the impulses
+    m_invMass.push_back(1.0f / (radius * radius * radius));
+    return GetCount() - 1;
+}
+
+int BallSystem::GetCount() const {
+    return (int)m_x.size();
+}
+
+void BallSystem::SetWalls(const ColliderSet* walls) {
+    m_walls = walls;
+}
+
+void BallSystem::SetWallResponse(float restitution, float friction) {
+    m_restitution = restitution;
+    m_friction = friction;
+}
+
+glm::vec3 BallSystem::GetPosition(int i) const {
+    return glm::vec3(m_x[i], m_y[i], m_z[i]);
+}
+
+glm::vec3 BallSystem::GetPreviousPosition(int i) const {
+    return glm::vec3(m_prevX[i], m_prevY[i], m_prevZ[i]);
+}
+
+glm::vec3 BallSystem::GetVelocity(int i) const {
+    return glm::vec3(m_vx[i], m_vy[i], m_vz[i]);
+}
+
+float BallSystem::GetRadius(int i) const {
+    return m_radius[i];
+}
+
+int BallSystem::GetPairCount() const {
+    return (int)m_broadphase.GetPairs().size();
+}
+
+int BallSystem::GetContactCount() const {
+    return m_contactCount;
+}
+
+const SweepAndPrune& BallSystem::GetBroadphase() const {
+    return m_broadphase;
+}
+
+/*
+    Resolves the contacts of the balls with the walls and with each other
+    Overlapping balls are pushed apart in proportion to their inverse mass and,
+    when they approach each other, exchange the elastic impulse
+        j = -2 (vRel . n) / (1/ma + 1/mb)
+    along the line between their centres
+*/
+void BallSystem::Collide() {
+    PROFILE_SCOPE("BallSystem::Collide");
+    int count = GetCount();
+
+    if (m_walls != NULL)
+        m_walls->Resolve(&m_x[0], &m_y[0], &m_z[0], &m_vx[0], &m_vy[0], &m_vz[0], &m_radius[0], count,
+                         m_restitution, m_friction);
+
+    m_broadphase.Update(&m_x[0], &m_y[0], &m_z[0], &m_radius[0], count);
+
+    m_contactCount = 0;
+    const std::vector<BroadphasePair>& pairs = m_broadphase.GetPairs();
+    for (size_t p = 0; p < pairs.size(); p++) {
+        int a = pairs[p].a;
+        int b = pairs[p].b;
+
+        float dx = m_x[b] - m_x[a];
+        float dy = m_y[b] - m_y[a];
+        float dz = m_z[b] - m_z[a];
+        float distance2 = dx * dx + dy * dy + dz * dz;
+        float reach = m_radius[a] + m_radius[b];
+        if (distance2 >= reach * reach || distance2 == 0.0f)
+            continue;
+
+        m_contactCount++;
+        float distance = std::sqrt(distance2);
+        float nx = dx / distance;
+        float ny = dy / distance;
+        float nz = dz / distance;
+        float wa = m_invMass[a];
+        float wb = m_invMass[b];
+        float w = wa + wb;
+
+        //  separate the balls
+        float push = (reach - distance) / w;
+        m_x[a] -= push * wa * nx;
+        m_y[a] -= push * wa * ny;
+        m_z[a] -= push * wa * nz;
+        m_x[b] += push * wb * nx;
+        m_y[b] += push * wb * ny;
+        m_z[b] += push * wb * nz;
+
+        //  only approaching balls bounce
+        float vn = (m_vx[b] - m_vx[a]) * nx + (m_vy[b] - m_vy[a]) * ny + (m_vz[b] - m_vz[a]) * nz;
+        if (vn >= 0.0f)
+            continue;
+
+        float j = -2.0f * vn / w;
+        m_vx[a] -= j * wa * nx;
+        m_vy[a] -= j * wa * ny;
+        m_vz[a] -= j * wa * nz;
+        m_vx[b] += j * wb * nx;
+        m_vy[b] += j * wb * ny;
+        m_vz[b] += j * wb * nz;
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#ifndef BALL_SYSTEM_H
+#define BALL_SYSTEM_H
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "ColliderSet.h"
+#include "Integrator.h"
+#include "Profiler.h"
+#include "SweepAndPrune.h"
+
+/*
+    Many balls of different sizes bouncing in the box and off each other
+
+    Ball state is stored as structure of arrays. A step integrates every
+    ball, resolves contacts with the walls with the batch kernel of
+    ColliderSet, finds the pairs of balls that may touch with a sweep and
+    prune broadphase and resolves those with an elastic impulse. Nothing in
+    the step compares all balls against each other, so its cost grows close
+    to linearly with the number of balls.
+*/
+class BallSystem
+{
+public:
+    BallSystem();
+
+    //  Returns the index of the new ball, its mass grows with its volume
+    int AddBall(const glm::vec3& position, const glm::vec3& velocity, float radius);
+    int GetCount() const;
+
+    //  Walls the balls bounce off, not owned
+    void SetWalls(const ColliderSet* walls);
+    //  Coefficients of ball-wall contacts, ball-ball contacts are perfectly elastic
+    void SetWallResponse(float restitution, float friction);
+
+    //  Advances every ball by h under the given forces
+    template <class Integrator = VelocityVerlet, class Forces>
+    void Step(const Forces& forces, float h);
+
+    glm::vec3 GetPosition(int i) const;
+    //  Position before the last step, for render interpolation
+    glm::vec3 GetPreviousPosition(int i) const;
+    glm::vec3 GetVelocity(int i) const;
+    float GetRadius(int i) const;
+
+    //  Broadphase pairs and ball-ball contacts of the last step
+    int GetPairCount() const;
+    int GetContactCount() const;
+    const SweepAndPrune& GetBroadphase() const;
+
+private:
+    std::vector<float> m_x, m_y, m_z;
+    std::vector<float> m_vx, m_vy, m_vz;
+    std::vector<float> m_prevX, m_prevY, m_prevZ;
+    std::vector<float> m_radius;
+    std::vector<float> m_invMass;
+
+    const ColliderSet* m_walls;
+    float m_restitution;
+    float m_friction;
+
+    SweepAndPrune m_broadphase;
+    int m_contactCount;
+
+    void Collide();
+};
+
+template <class Integrator, class Forces>
+void BallSystem::Step(const Forces& forces, float h) {
+    PROFILE_SCOPE("BallSystem::Step");
+    int count = GetCount();
+    if (count == 0)
+        return;
+
+    m_prevX = m_x;
+    m_prevY = m_y;
+    m_prevZ = m_z;
+
+    float* x = &m_x[0];
+    float* y = &m_y[0];
+    float* z = &m_z[0];
+    float* vx = &m_vx[0];
+    float* vy = &m_vy[0];
+    float* vz = &m_vz[0];
+    for (int i = 0; i < count; i++)
+        Integrator::Step(forces, h, x[i], y[i], z[i], vx[i], vy[i], vz[i]);
+
+    Collide();
+}
+
+#endif // !BALL_SYSTEM_H
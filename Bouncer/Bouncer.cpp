@@ -15,12 +15,28 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 //  C++ headers
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <random>
+#include <string>
+#include <vector>
 
 //  Custon headers
 #include "Camera.h"
+#include "CameraBuffer.h"
 #include "Shader.h"
 #include "Texture.h"
+#include "BallSystem.h"
+#include "FixedTimestep.h"
+#include "LodSelector.h"
+#include "MeshRegistry.h"
+#include "PerformanceOverlay.h"
+#include "ProceduralMesh.h"
+#include "Profiler.h"
 #include "Simulation.h"
 
 
@@ -31,19 +47,27 @@ void MouseCallback(GLFWwindow* window, double x_pos, double y_pos);
 void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
 void ScrollCallback(GLFWwindow* window, double x_offSet, double y_offSet);
 
-//  Shape functions
-void RenderSphere();
-void RenderBox();
+//  Headless batch run
+void RunHeadless(int steps, int ballCount, float tolerance);
+
+//  Multiple balls
+void CreateBalls(BallSystem& balls, int count);
+
+//  Shapes
+void CreateMeshes();
 
 
 //  Screen
 const unsigned int SCREEN_WIDTH = 1280;
 const unsigned int SCREEN_HEIGHT = 720;
 
-//  Shape variables
-GLuint sphereVAO = 0;
-GLuint indexCount;
-unsigned int cubeVBO, cubeVAO;
+//  Shapes, uploaded once by CreateMeshes
+MeshRegistry meshes;
+const int SPHERE_SEGMENTS = 64;                 //  segments of the finest sphere
+const int SPHERE_LODS = 4;                      //  64, 32, 16 and 8 segments
+MeshHandle sphereMeshes[SPHERE_LODS];
+LodSelector sphereLods(SPHERE_SEGMENTS, SPHERE_LODS);
+MeshHandle boxMesh = INVALID_MESH;
 
 //  Ball variables
 glm::vec3 ballPosition(0.0, 0.0, 0.0);      //  Specifies the initial position
@@ -63,11 +87,63 @@ bool mouseClickActive = false;
 //  Shaders
 Shader ball;
 Shader box;
+CameraBuffer cameraBuffer;
 
 //  Textures
 Texture boxTex;
 
-int main() {
+//  Performance HUD
+PerformanceOverlay overlay;
+
+//  Simulation constants
+float timestep = 0.01f;                                         //  timestep, h
+const glm::vec3 initialVelocity = glm::vec3(30.0f, 10.8f, 80.0f);   //  starting velocity
+const glm::vec3 gravity = glm::vec3(0.0f, -9.8f, 0.0f);         //  constant gravity
+
+int main(int argc, char** argv) {
+
+    //  Command line
+    //  --headless      run the simulation without a window or GL context
+    //  --steps N       number of steps for the headless run
+    //  --balls N       simulate N balls of different sizes that also collide with each other
+    //  --timestep H    seconds of simulated time per physics step
+    //  --adaptive TOL  step the single ball adaptively with the given error tolerance, up to 0.1 s per step,
+    //                  not available with --balls
+    //  --trace FILE    write the profiler zones as a Chrome trace on exit, needs the Profile build
+    bool headless = false;
+    int steps = 1000;
+    int ballCount = 0;
+    float tolerance = 0.0f;
+    const char* tracePath = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0)
+            headless = true;
+        else if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+            steps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--balls") == 0 && i + 1 < argc)
+            ballCount = std::max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--adaptive") == 0 && i + 1 < argc)
+            tolerance = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--timestep") == 0 && i + 1 < argc)
+            timestep = std::max(1.0e-5f, (float)atof(argv[++i]));
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            tracePath = argv[++i];
+        else
+            std::cout << "Ignoring unknown argument " << argv[i] << std::endl;
+    }
+    if (tolerance > 0.0f && ballCount > 0) {
+        std::cout << "Ignoring --adaptive, it only steps the single ball and not the --balls system" << std::endl;
+        tolerance = 0.0f;
+    }
+
+    PROFILE_THREAD("Main");
+
+    if (headless) {
+        RunHeadless(steps, ballCount, tolerance);
+        if (tracePath != NULL)
+            Profiler::WriteChromeTrace(tracePath);
+        return 0;
+    }
 
     //  GLFW: Initialization
     glfwInit();
@@ -99,34 +175,95 @@ int main() {
     //  Enable depth testing
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_CULL_FACE);
-    glCullFace(GL_FRONT);
+
+    overlay.Init(window);
 
     //  Load Shader
     ball.LoadShader("ball.vert", "ball.frag");
     box.LoadShader("box.vert", "box.frag");
+
+    //  uniforms set every frame are set by location, the camera matrices
+    //  are in a uniform buffer shared by both
+    const GLint ballModel = ball.GetUniform("model");
+    const GLint boxModel = box.GetUniform("model");
+    cameraBuffer.Init();
     
     boxTex.LoadTexture("images/tiles.jpg", "boxTex");
 
+    //  all geometry is uploaded here, frames only draw it
+    CreateMeshes();
+    const int meshObjects = meshes.GetObjectCount();
+
     StartSimulation(ballPosition);
 
-    float h = 0.01f;                                            //  timestep
-    float fraction = 1.0f;                                      //  fraction
-    glm::vec3 velocity = glm::vec3(30.0f, 10.8f, 80.0f);        //  starting velocity
-    const glm::vec3 gravity = glm::vec3(0.0f, -9.8f, 0.0f);     //  constant gravity
+    glm::vec3 velocity = initialVelocity;                       //  starting velocity
     const float mass = 1.0f;                                    //  mass of ball
     float airResistanceConstant = 0.5f;                         //  constant for air resistance
     glm::vec3 windVelocity = glm::vec3(0.0f, 0.0f, 0.0f);       //  wind velocity
 
+    //  Forces on the ball, air resistance is off for now
+    //  add  + Wind(windVelocity, airResistanceConstant / mass)  to turn it on
+    const auto forces = Gravity(gravity);
+
+    //  Physics runs in fixed steps of h whatever the frame rate, the ball is
+    //  drawn between its last two physics positions
+    FixedTimestep clock(timestep);
+    glm::vec3 previousPosition = ballPosition;
+
+    //  With --adaptive the ball takes its own steps within every fixed step
+    AdaptiveStep adaptive(tolerance);
+
+    //  With --balls the single ball is replaced by many
+    BallSystem balls;
+    CreateBalls(balls, ballCount);
+
+    //  sphere level of detail of every ball in the last frame
+    std::vector<int> ballLods;
+    int singleBallLod = 0;
+
+    //  Runtime controls of the overlay, 0 balls is the single ball
+    OverlayControls controls;
+    controls.count = &ballCount;
+    controls.maxCount = 2000;
+    controls.countLabel = "Balls";
+    controls.timestep = &timestep;
+
     //  RENDER LOOP
     while (!glfwWindowShouldClose(window)) {
+        PROFILE_SCOPE("Frame");
 
         //  per-frame time logic
         float currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
+        overlay.NewFrame(deltaTime);
 
         //  Process input
-        ProcessInput(window);
+        {
+            PROFILE_SCOPE("Input");
+            ProcessInput(window);
+        }
+
+        //  Simulation takes place here
+        unsigned long long simulationStart = Profiler::Now();
+        int substeps = clock.Advance(deltaTime);
+        for (int i = 0; i < substeps; i++) {
+            PROFILE_SCOPE("Simulation");
+            if (ballCount > 0) {
+                balls.Step(forces, clock.GetStep());
+            }
+            else {
+                previousPosition = ballPosition;
+                if (tolerance > 0.0f)
+                    AdvanceBall(ballPosition, velocity, clock.GetStep(), forces, adaptive);
+                else
+                    StepBall(ballPosition, velocity, clock.GetStep(), forces);
+            }
+        }
+        float alpha = clock.GetAlpha();
+        unsigned long long renderStart = Profiler::Now();
+        overlay.SetSimulation((renderStart - simulationStart) * 1.0e-6f, substeps);
+        overlay.SetBodyCount(ballCount > 0 ? balls.GetCount() : 1, std::max(ballCount, 1));
 
         glClearColor(0.2, 0.2, 0.2, 1.0);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -135,77 +272,171 @@ int main() {
         glm::mat4 projection = glm::perspective(camera.Zoom, (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
         glm::mat4 view = camera.GetViewMatrix();
 
-        //  Set ball shader
-        ball.Use();
-        ball.SetMat4("projection", projection);
-        ball.SetMat4("view", view);
-
-        glm::mat4 ballModel;
-        ballModel = glm::translate(ballModel, ballPosition);
-        ballModel = glm::scale(ballModel, glm::vec3(1.0f));
-        ball.SetMat4("model", ballModel);
-        //  render sphere
-        RenderSphere();
-        //ballPosition = UpdatePosition(ballPosition);
-        
-        //  Calculating acceleration taking into account gravity and air resistance
-        //glm::vec3 acceleration = gravity + (airResistanceConstant / mass) * (windVelocity - velocity);
-        glm::vec3 acceleration = gravity;
-        //std::cout << "Acceleration: "<<acceleration.x << " " << acceleration.y << " " << acceleration.z << std::endl;
-        //  Euler simulation
-        glm::vec3 newVelocity = velocity + acceleration*h;
-        glm::vec3 newPosition = ballPosition + h*((newVelocity + velocity) / 2.0f);
-
-        //std::cout << "Incoming velocity: " << newVelocity.x << " " << newVelocity.y << " " << newVelocity.z << std::endl;
-        if (CollisionCheck(newPosition)) {
-            //std::cout << "------------" << std::endl;
-            //std::cout << "Collision occured" << std::endl;
-            float dCurrent = FindDistance(ballPosition);
-            float dNext = FindDistance(newPosition);
-
-            fraction = dCurrent / (dCurrent - dNext);
-            //h = fraction * h;
-            //std::cout << h << std::endl;
-
-            velocity = CollisionResponse(newVelocity);
-            ballPosition = ballPosition;
-
-            //std::cout << "------------" << std::endl;
+        {
+            PROFILE_SCOPE("Uniforms");
+            cameraBuffer.Update(projection, view);
         }
-        else {
-            //  Updating velocity and position for next frame
-            velocity = newVelocity;
-            ballPosition = newPosition;
 
-            //  Resetting timestep
-            //h = h / fraction;
-        }
+        //  Set ball shader, balls are seen from outside
+        ball.Use();
+        glCullFace(GL_BACK);
 
+        //  model matrices are uploaded ball by ball, they count as drawing
+        //  every ball is drawn with the sphere level of detail for its size on screen
+        {
+            PROFILE_SCOPE("Draw");
+            if (ballCount > 0) {
+                ballLods.resize(balls.GetCount(), 0);
+                for (int i = 0; i < balls.GetCount(); i++) {
+                    glm::vec3 position = glm::mix(balls.GetPreviousPosition(i), balls.GetPosition(i), alpha);
+                    float pixelRadius = camera.ProjectedRadius(position, balls.GetRadius(i), projection, (float)SCREEN_HEIGHT);
+                    ballLods[i] = sphereLods.Select(pixelRadius, ballLods[i]);
+
+                    glm::mat4 model;
+                    model = glm::translate(model, position);
+                    model = glm::scale(model, glm::vec3(balls.GetRadius(i)));
+                    ball.SetMat4(ballModel, model);
+                    meshes.Draw(sphereMeshes[ballLods[i]]);
+                }
+            }
+            else {
+                glm::vec3 position = glm::mix(previousPosition, ballPosition, alpha);
+                float pixelRadius = camera.ProjectedRadius(position, 1.0f, projection, (float)SCREEN_HEIGHT);
+                singleBallLod = sphereLods.Select(pixelRadius, singleBallLod);
+
+                glm::mat4 model;
+                model = glm::translate(model, position);
+                model = glm::scale(model, glm::vec3(1.0f));
+                ball.SetMat4(ballModel, model);
+                //  render sphere
+                meshes.Draw(sphereMeshes[singleBallLod]);
+            }
+        }
+        //ballPosition = UpdatePosition(ballPosition);
 
-        //  Set box shader
+        //  Set box shader, the box is seen from inside
         box.Use();
-        glm::mat4 boxModel;
-        box.SetMat4("projection", projection);
-        box.SetMat4("view", view);
-        //  model matrix Set
-        boxModel = glm::scale(boxModel, glm::vec3(14.5f));
-        box.SetMat4("model", boxModel);
-        //  bind textures
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, boxTex.GetTextureID());
-        // render the cube
-        RenderBox();
+        glCullFace(GL_FRONT);
+        {
+            PROFILE_SCOPE("Draw");
+            //  model matrix Set
+            glm::mat4 model;
+            model = glm::scale(model, glm::vec3(14.5f));
+            box.SetMat4(boxModel, model);
+            //  bind textures
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, boxTex.GetTextureID());
+            // render the cube
+            meshes.Draw(boxMesh);
+        }
+        overlay.SetRenderTime((Profiler::Now() - renderStart) * 1.0e-6f);
+
+        //  the overlay goes on top of the scene, changes apply from the next frame
+        if (overlay.Draw(controls)) {
+            clock.SetStep(timestep);
+            if (ballCount != balls.GetCount()) {
+                balls = BallSystem();
+                CreateBalls(balls, ballCount);
+            }
+        }
+
+        //  frames must not create GL objects
+        assert(meshes.GetObjectCount() == meshObjects);
 
         //  Swap buffers and poll IO events
+        PROFILE_SCOPE("SwapBuffers");
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
-    //  terminate
+    if (tracePath != NULL)
+        Profiler::WriteChromeTrace(tracePath);
+
+    //  terminate, GL objects go before the context
+    meshes.Clear();
+    overlay.Shutdown();
     glfwTerminate();
     return 0;
 }
 
+/*
+    Runs the ball simulation for a fixed number of steps without any rendering
+    and reports the throughput
+*/
+void RunHeadless(int steps, int ballCount, float tolerance) {
+    StartSimulation(ballPosition);
+
+    glm::vec3 velocity = initialVelocity;
+    BallSystem balls;
+    CreateBalls(balls, ballCount);
+    int bodies = ballCount > 0 ? ballCount : 1;
+    std::cout << "Headless run: " << bodies << " balls, " << steps << " steps" << std::endl;
+
+    //  broadphase statistics, summed over the steps
+    double pairs = 0.0, contacts = 0.0, swaps = 0.0;
+
+    //  the adaptive run covers the same simulated time in steps of its own
+    AdaptiveStep adaptive(tolerance);
+    bool adaptiveBall = tolerance > 0.0f && ballCount == 0;
+
+    //  steps actually taken, the rejected trial steps of the adaptive run are reported apart
+    int takenSteps = steps;
+
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    if (adaptiveBall)
+        takenSteps = AdvanceBall(ballPosition, velocity, steps * timestep, Gravity(gravity), adaptive);
+    for (int i = 0; i < steps && !adaptiveBall; i++) {
+        if (ballCount > 0) {
+            balls.Step(Gravity(gravity), timestep);
+            pairs += balls.GetPairCount();
+            contacts += balls.GetContactCount();
+            swaps += balls.GetBroadphase().GetSwapCount();
+        }
+        else {
+            StepBall(ballPosition, velocity, timestep, gravity);
+        }
+    }
+    std::chrono::high_resolution_clock::time_point stop = std::chrono::high_resolution_clock::now();
+
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    double stepsPerSecond = seconds > 0.0 ? takenSteps / seconds : 0.0;
+
+    std::cout << "Wall time: " << seconds << " s" << std::endl;
+    std::cout << "Steps/sec: " << stepsPerSecond << std::endl;
+    std::cout << "Particle steps/sec: " << stepsPerSecond * bodies << std::endl;
+    if (adaptiveBall)
+        std::cout << "Adaptive steps: " << takenSteps << " accepted, " << adaptive.rejected << " rejected, instead of " << steps << std::endl;
+    if (ballCount > 0 && steps > 0) {
+        std::cout << "Broadphase pairs/step: " << pairs / steps << ", contacts/step: " << contacts / steps
+                  << ", sort swaps/step: " << swaps / steps << std::endl;
+        std::cout << "Final position of ball 0: " << balls.GetPosition(0).x << " " << balls.GetPosition(0).y << " " << balls.GetPosition(0).z << std::endl;
+    }
+    else {
+        std::cout << "Final position: " << ballPosition.x << " " << ballPosition.y << " " << ballPosition.z << std::endl;
+    }
+}
+
+/*
+    Fills the box with count balls of random size, position and velocity
+    The walls must be configured, the seed is fixed so every run starts the same
+*/
+void CreateBalls(BallSystem& balls, int count) {
+    balls.SetWalls(&GetWalls());
+
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> size(0.2f, 0.6f);
+
+    const float halfBox = 15.0f;
+    for (int i = 0; i < count; i++) {
+        float radius = size(random);
+        float extent = halfBox - radius;
+        glm::vec3 position(unit(random) * extent, unit(random) * extent, unit(random) * extent);
+        glm::vec3 velocity(unit(random) * 10.0f, unit(random) * 10.0f, unit(random) * 10.0f);
+        balls.AddBall(position, velocity, radius);
+    }
+}
+
 /*
     Whenever the window size is changed (automatically by OS, or manually by user) this function is called
 */
@@ -255,6 +486,12 @@ void MouseCallback(GLFWwindow* window, double x_pos, double y_pos) {
     Activates mouse when left button is clicked
 */
 void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+    overlay.OnMouseButton(window, button, action, mods);
+    if (overlay.WantsMouse()) {
+        mouseClickActive = false;
+        return;
+    }
+
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
         mouseClickActive = true;
     else
@@ -265,171 +502,23 @@ void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
     Whenever mouse scroll wheel is used, this function is called
 */
 void ScrollCallback(GLFWwindow* window, double x_offSet, double y_offSet) {
+    overlay.OnScroll(window, x_offSet, y_offSet);
+    if (overlay.WantsMouse())
+        return;
     camera.ProcessMouseScroll(y_offSet);
 }
 
 
 /*
-    Renders a sphere
-*/
-void RenderSphere()
-{
-    if (sphereVAO == 0)
-    {
-        glGenVertexArrays(1, &sphereVAO);
-
-        GLuint vbo, ebo;
-        glGenBuffers(1, &vbo);
-        glGenBuffers(1, &ebo);
-
-        std::vector<glm::vec3> positions;
-        std::vector<glm::vec2> uv;
-        std::vector<glm::vec3> normals;
-        std::vector<GLuint> indices;
-
-        const GLuint X_SEGMENTS = 64;
-        const GLuint Y_SEGMENTS = 64;
-        const float PI = 3.14159265359;
-        for (GLuint y = 0; y <= Y_SEGMENTS; ++y)
-        {
-            for (GLuint x = 0; x <= X_SEGMENTS; ++x)
-            {
-                float xSegment = (float)x / (float)X_SEGMENTS;
-                float ySegment = (float)y / (float)Y_SEGMENTS;
-                float xPos = std::cos(xSegment * 2.0f * PI) * std::sin(ySegment * PI);
-                float yPos = std::cos(ySegment * PI);
-                float zPos = std::sin(xSegment * 2.0f * PI) * std::sin(ySegment * PI);
-
-                positions.push_back(glm::vec3(xPos, yPos, zPos));
-                uv.push_back(glm::vec2(xSegment, ySegment));
-                normals.push_back(glm::vec3(xPos, yPos, zPos));
-            }
-        }
-
-        bool oddRow = false;
-        for (int y = 0; y < Y_SEGMENTS; ++y)
-        {
-            if (!oddRow) // even rows: y == 0, y == 2; and so on
-            {
-                for (int x = 0; x <= X_SEGMENTS; ++x)
-                {
-                    indices.push_back(y       * (X_SEGMENTS + 1) + x);
-                    indices.push_back((y + 1) * (X_SEGMENTS + 1) + x);
-                }
-            }
-            else
-            {
-                for (int x = X_SEGMENTS; x >= 0; --x)
-                {
-                    indices.push_back((y + 1) * (X_SEGMENTS + 1) + x);
-                    indices.push_back(y       * (X_SEGMENTS + 1) + x);
-                }
-            }
-            oddRow = !oddRow;
-        }
-        indexCount = indices.size();
-
-        std::vector<float> data;
-        for (int i = 0; i < positions.size(); ++i)
-        {
-            data.push_back(positions[i].x);
-            data.push_back(positions[i].y);
-            data.push_back(positions[i].z);
-            if (uv.size() > 0)
-            {
-                data.push_back(uv[i].x);
-                data.push_back(uv[i].y);
-            }
-            if (normals.size() > 0)
-            {
-                data.push_back(normals[i].x);
-                data.push_back(normals[i].y);
-                data.push_back(normals[i].z);
-            }
-        }
-        glBindVertexArray(sphereVAO);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), &data[0], GL_STATIC_DRAW);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), &indices[0], GL_STATIC_DRAW);
-        float stride = (3 + 2 + 3) * sizeof(float);
-        glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
-        glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, stride, (void*)(5 * sizeof(float)));
-    }
-
-    glBindVertexArray(sphereVAO);
-    glDrawElements(GL_TRIANGLE_STRIP, indexCount, GL_UNSIGNED_INT, 0);
-}
-
-/*
-    Renders the box
+    Uploads the levels of detail of the sphere and the box to the mesh registry
 */
-void RenderBox() {
-    float box_vertices[] = {
-        // Back face
-        -1.0f, -1.0f, -1.0f,  0.0f, 0.0f, // Bottom-left
-        1.0f,  1.0f, -1.0f,  1.0f, 1.0f, // top-right
-        1.0f, -1.0f, -1.0f,  1.0f, 0.0f, // bottom-right         
-        1.0f,  1.0f, -1.0f,  1.0f, 1.0f, // top-right
-        -1.0f, -1.0f, -1.0f,  0.0f, 0.0f, // bottom-left
-        -1.0f,  1.0f, -1.0f,  0.0f, 1.0f, // top-left
-                                          // Front face
-                                          -1.0f, -1.0f,  1.0f,  0.0f, 0.0f, // bottom-left
-                                          1.0f, -1.0f,  1.0f,  1.0f, 0.0f, // bottom-right
-                                          1.0f,  1.0f,  1.0f,  1.0f, 1.0f, // top-right
-                                          1.0f,  1.0f,  1.0f,  1.0f, 1.0f, // top-right
-                                          -1.0f,  1.0f,  1.0f,  0.0f, 1.0f, // top-left
-                                          -1.0f, -1.0f,  1.0f,  0.0f, 0.0f, // bottom-left                                 
-                                                                            // Left face                                                                    
-                                                                            -1.0f,  1.0f,  1.0f,  1.0f, 0.0f, // top-right                                                                    
-                                                                            -1.0f,  1.0f, -1.0f,  1.0f, 1.0f, // top-left
-                                                                            -1.0f, -1.0f, -1.0f,  0.0f, 1.0f, // bottom-left
-                                                                            -1.0f, -1.0f, -1.0f,  0.0f, 1.0f, // bottom-left
-                                                                            -1.0f, -1.0f,  1.0f,  0.0f, 0.0f, // bottom-right
-                                                                            -1.0f,  1.0f,  1.0f,  1.0f, 0.0f, // top-right
-                                                                                                              // Right face
-                                                                                                              1.0f,  1.0f,  1.0f,  1.0f, 0.0f, // top-left
-                                                                                                              1.0f, -1.0f, -1.0f,  0.0f, 1.0f, // bottom-right
-                                                                                                              1.0f,  1.0f, -1.0f,  1.0f, 1.0f, // top-right         
-                                                                                                              1.0f, -1.0f, -1.0f,  0.0f, 1.0f, // bottom-right
-                                                                                                              1.0f,  1.0f,  1.0f,  1.0f, 0.0f, // top-left
-                                                                                                              1.0f, -1.0f,  1.0f,  0.0f, 0.0f, // bottom-left     
-                                                                                                                                               // Bottom face
-                                                                                                                                               -1.0f, -1.0f, -1.0f,  0.0f, 1.0f, // top-right
-                                                                                                                                               1.0f, -1.0f, -1.0f,  1.0f, 1.0f, // top-left
-                                                                                                                                               1.0f, -1.0f,  1.0f,  1.0f, 0.0f, // bottom-left
-                                                                                                                                               1.0f, -1.0f,  1.0f,  1.0f, 0.0f, // bottom-left
-                                                                                                                                               -1.0f, -1.0f,  1.0f,  0.0f, 0.0f, // bottom-right
-                                                                                                                                               -1.0f, -1.0f, -1.0f,  0.0f, 1.0f, // top-right
-                                                                                                                                                                                 // Top face
-                                                                                                                                                                                 -1.0f,  1.0f, -1.0f,  0.0f, 1.0f, // top-left
-                                                                                                                                                                                 1.0f,  1.0f,  1.0f,  1.0f, 0.0f, // bottom-right
-                                                                                                                                                                                 1.0f,  1.0f, -1.0f,  1.0f, 1.0f, // top-right     
-                                                                                                                                                                                 1.0f,  1.0f,  1.0f,  1.0f, 0.0f, // bottom-right
-                                                                                                                                                                                 -1.0f,  1.0f, -1.0f,  0.0f, 1.0f, // top-left
-                                                                                                                                                                                 -1.0f,  1.0f,  1.0f,  0.0f, 0.0f  // bottom-left                                                                   
-    };
-    glGenVertexArrays(1, &cubeVAO);
-    glGenBuffers(1, &cubeVBO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(box_vertices), box_vertices, GL_STATIC_DRAW);
-
-    glBindVertexArray(cubeVAO);
-
-    float stride = (3 + 2) * sizeof(float);
-    //  position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
-    glEnableVertexAttribArray(0);
-    //  texture coordinate attributes
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    //  render the box
-    glBindVertexArray(cubeVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
+void CreateMeshes() {
+    std::vector<MeshData> lods;
+    BuildUVSphereLods(lods, SPHERE_SEGMENTS, SPHERE_LODS);
+    for (int level = 0; level < SPHERE_LODS; level++)
+        sphereMeshes[level] = meshes.Create("sphere" + std::to_string(level), lods[level]);
+
+    MeshData mesh;
+    BuildBox(mesh);
+    boxMesh = meshes.Create("box", mesh);
 }
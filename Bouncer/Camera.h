@@ -119,6 +119,17 @@ public:
             Zoom = 45.0f;
     }
 
+    // Radius in pixels of a sphere on screen under the given projection, from the distance to its centre so it does not change when the camera only turns
+    GLfloat ProjectedRadius(vec3 center, GLfloat radius, const mat4& projection, GLfloat viewportHeight) const
+    {
+        vec3 offset = center - Position;
+        GLfloat distance2 = dot(offset, offset);
+        if (distance2 <= radius * radius)
+            return viewportHeight;
+        // the sphere's outline lies at an angle of asin(radius / distance) from its centre
+        return radius / sqrt(distance2 - radius * radius) * projection[1][1] * 0.5f * viewportHeight;
+    }
+
 private:
     // Calculates the front vector from the Camera's (updated) Eular Angles
     void updateCameraVectors()
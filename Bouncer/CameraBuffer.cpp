@@ -0,0 +1,39 @@
+//  Contains the member functions of CAMERA_BUFFER.H
+
+#include "CameraBuffer.h"
+
+//  std140 puts a mat4 on 16 byte columns, same as glm
+static_assert(sizeof(CameraBlock) == 2 * 16 * sizeof(float), "CameraBlock must match the std140 layout");
+
+CameraBuffer::CameraBuffer() :
+    m_buffer(0)
+{
+}
+
+CameraBuffer::~CameraBuffer() {
+    //  nothing to delete if Init was never called (e.g. no GL context)
+    if (m_buffer != 0)
+        glDeleteBuffers(1, &m_buffer);
+}
+
+void CameraBuffer::Init() {
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BINDING, m_buffer);
+}
+
+void CameraBuffer::Update(const glm::mat4& projection, const glm::mat4& view) {
+    CameraBlock block;
+    block.projection = projection;
+    block.view = view;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+GLuint CameraBuffer::GetBufferID() const {
+    return m_buffer;
+}
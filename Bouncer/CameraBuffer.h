@@ -0,0 +1,43 @@
+#pragma once
+
+#ifndef CAMERA_BUFFER_H
+#define CAMERA_BUFFER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+//  Binding point of the camera block, matches layout(binding = ...) in the shaders
+const GLuint CAMERA_BINDING = 0;
+
+//  Contents of the camera block, laid out as std140
+struct CameraBlock
+{
+    glm::mat4 projection;
+    glm::mat4 view;
+};
+
+/*
+    Uniform buffer with the camera matrices of the frame
+
+    The buffer stays bound to CAMERA_BINDING, so every program that declares
+        layout (std140, binding = 0) uniform Camera { mat4 projection; mat4 view; };
+    reads the same matrices. They are written once per frame, however many
+    programs and objects are drawn.
+*/
+class CameraBuffer
+{
+public:
+    CameraBuffer();
+    ~CameraBuffer();
+
+    //  Creates the buffer, needs a GL context
+    void Init();
+    //  Writes the matrices of this frame
+    void Update(const glm::mat4& projection, const glm::mat4& view);
+    GLuint GetBufferID() const;
+
+private:
+    GLuint m_buffer;
+};
+
+#endif // !CAMERA_BUFFER_H
@@ -0,0 +1,177 @@
+/*
+    Implementation of COLLIDER_SET_H
+*/
+
+#include "ColliderSet.h"
+#include <algorithm>
+
+ColliderSet::ColliderSet()
+{
+}
+
+int ColliderSet::AddPlane(const glm::vec3& point, const glm::vec3& normal)
+{
+    glm::vec3 n = glm::normalize(normal);
+    m_nx.push_back(n.x);
+    m_ny.push_back(n.y);
+    m_nz.push_back(n.z);
+    m_d.push_back(glm::dot(n, point));
+    return (int)m_d.size() - 1;
+}
+
+void ColliderSet::Clear()
+{
+    m_nx.clear();
+    m_ny.clear();
+    m_nz.clear();
+    m_d.clear();
+}
+
+int ColliderSet::GetPlaneCount() const
+{
+    return (int)m_d.size();
+}
+
+glm::vec3 ColliderSet::GetNormal(int plane) const
+{
+    return glm::vec3(m_nx[plane], m_ny[plane], m_nz[plane]);
+}
+
+float ColliderSet::GetOffset(int plane) const
+{
+    return m_d[plane];
+}
+
+//  Radius of every sphere of a batch, the same for all of them or one per sphere
+namespace
+{
+    struct UniformRadius
+    {
+        float r;
+        float operator[](int) const { return r; }
+        UniformRadius Offset(int) const { return *this; }
+    };
+
+    struct RadiusArray
+    {
+        const float* __restrict r;
+        float operator[](int i) const { return r[i]; }
+        RadiusArray Offset(int begin) const { RadiusArray shifted = { r + begin }; return shifted; }
+    };
+}
+
+template <class Radius>
+void ColliderSet::TestBatch(const float* x, const float* y, const float* z, Radius radius, int count, float* depth, int* plane) const
+{
+    const float* __restrict px = x;
+    const float* __restrict py = y;
+    const float* __restrict pz = z;
+    float* __restrict outDepth = depth;
+    int* __restrict outPlane = plane;
+    const int planes = GetPlaneCount();
+
+    for (int begin = 0; begin < count; begin += COLLIDER_TILE_SIZE)
+    {
+        int end = std::min(begin + COLLIDER_TILE_SIZE, count);
+
+        for (int i = begin; i < end; i++)
+        {
+            outDepth[i] = 0.0f;
+            outPlane[i] = -1;
+        }
+
+        //  depth = (d + r) - dot(n, p), kept when deeper than the best so far
+        for (int j = 0; j < planes; j++)
+        {
+            const float nx = m_nx[j];
+            const float ny = m_ny[j];
+            const float nz = m_nz[j];
+            const float offset = m_d[j];
+
+            for (int i = begin; i < end; i++)
+            {
+                float d = offset + radius[i] - (nx * px[i] + ny * py[i] + nz * pz[i]);
+                bool deeper = d > outDepth[i];
+                outDepth[i] = deeper ? d : outDepth[i];
+                outPlane[i] = deeper ? j : outPlane[i];
+            }
+        }
+    }
+}
+
+void ColliderSet::Test(const float* x, const float* y, const float* z, int count, float radius, float* depth, int* plane) const
+{
+    UniformRadius r = { radius };
+    TestBatch(x, y, z, r, count, depth, plane);
+}
+
+void ColliderSet::Test(const float* x, const float* y, const float* z, const float* radius, int count, float* depth, int* plane) const
+{
+    RadiusArray r = { radius };
+    TestBatch(x, y, z, r, count, depth, plane);
+}
+
+int ColliderSet::Test(const glm::vec3& position, float radius, float& depth) const
+{
+    int plane;
+    Test(&position.x, &position.y, &position.z, 1, radius, &depth, &plane);
+    return plane;
+}
+
+template <class Radius>
+void ColliderSet::ResolveBatch(float* x, float* y, float* z, float* vx, float* vy, float* vz, Radius radius, int count,
+                               float restitution, float friction) const
+{
+    float depth[COLLIDER_TILE_SIZE];
+    int plane[COLLIDER_TILE_SIZE];
+
+    for (int begin = 0; begin < count; begin += COLLIDER_TILE_SIZE)
+    {
+        int n = std::min(COLLIDER_TILE_SIZE, count - begin);
+        TestBatch(x + begin, y + begin, z + begin, radius.Offset(begin), n, depth, plane);
+
+        //  contacts are rare, the response only runs for the bodies that have one
+        for (int k = 0; k < n; k++)
+        {
+            if (plane[k] < 0)
+                continue;
+
+            int i = begin + k;
+            int j = plane[k];
+            float nx = m_nx[j], ny = m_ny[j], nz = m_nz[j];
+
+            //  back onto the plane
+            x[i] += depth[k] * nx;
+            y[i] += depth[k] * ny;
+            z[i] += depth[k] * nz;
+
+            //  only a body moving into the plane bounces
+            float vn = vx[i] * nx + vy[i] * ny + vz[i] * nz;
+            if (vn >= 0.0f)
+                continue;
+
+            float tx = vx[i] - vn * nx;
+            float ty = vy[i] - vn * ny;
+            float tz = vz[i] - vn * nz;
+            float bounce = -restitution * vn;
+            float keep = 1.0f - friction;
+            vx[i] = keep * tx + bounce * nx;
+            vy[i] = keep * ty + bounce * ny;
+            vz[i] = keep * tz + bounce * nz;
+        }
+    }
+}
+
+void ColliderSet::Resolve(float* x, float* y, float* z, float* vx, float* vy, float* vz, int count,
+                          float radius, float restitution, float friction) const
+{
+    UniformRadius r = { radius };
+    ResolveBatch(x, y, z, vx, vy, vz, r, count, restitution, friction);
+}
+
+void ColliderSet::Resolve(float* x, float* y, float* z, float* vx, float* vy, float* vz, const float* radius, int count,
+                          float restitution, float friction) const
+{
+    RadiusArray r = { radius };
+    ResolveBatch(x, y, z, vx, vy, vz, r, count, restitution, friction);
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+/*
+    Decouples the physics step from the frame rate
+
+    Every frame the elapsed real time is added to an accumulator and Advance
+    returns how many fixed steps of h fit into it, so the simulation runs at
+    the same speed whatever the frame rate is. A slow frame is caught up with
+    several steps in the next one, but never more than maxSubsteps: time
+    beyond that is dropped so one slow frame cannot make the next even slower
+    (the spiral of death), the simulation just runs slower for a moment.
+
+    The time left in the accumulator is a fraction of a step, GetAlpha
+    returns it in [0, 1] to blend the last two physics states for rendering.
+
+        int steps = clock.Advance(deltaTime);
+        for (int i = 0; i < steps; i++) {
+            previous = current;
+            Step(current, clock.GetStep());
+        }
+        Render(mix(previous, current, clock.GetAlpha()));
+*/
+class FixedTimestep
+{
+public:
+    FixedTimestep(float step = 0.01f, int maxSubsteps = 5) :
+        m_step(step), m_maxSubsteps(maxSubsteps), m_accumulator(0.0f), m_droppedTime(0.0f)
+    {
+    }
+
+    //  Adds frameTime seconds of real time, returns the number of steps to run now
+    int Advance(float frameTime)
+    {
+        if (frameTime > 0.0f)
+            m_accumulator += frameTime;
+
+        int steps = (int)(m_accumulator / m_step);
+        if (steps > m_maxSubsteps) {
+            float dropped = (steps - m_maxSubsteps) * m_step;
+            m_droppedTime += dropped;
+            m_accumulator -= dropped;
+            steps = m_maxSubsteps;
+        }
+
+        m_accumulator -= steps * m_step;
+        if (m_accumulator < 0.0f)
+            m_accumulator = 0.0f;
+        return steps;
+    }
+
+    //  Fraction of a step between the last physics state and the current time
+    float GetAlpha() const
+    {
+        //  rounding can leave a hair over a full step, it is run next frame
+        float alpha = m_accumulator / m_step;
+        return alpha < 1.0f ? alpha : 1.0f;
+    }
+
+    float GetStep() const
+    {
+        return m_step;
+    }
+
+    //  Changes the step from the next Advance on, the time already accumulated is kept
+    void SetStep(float step)
+    {
+        if (step > 0.0f)
+            m_step = step;
+    }
+
+    int GetMaxSubsteps() const
+    {
+        return m_maxSubsteps;
+    }
+
+    //  Real time that was not simulated because of the substep cap, in seconds
+    float GetDroppedTime() const
+    {
+        return m_droppedTime;
+    }
+
+private:
+    float m_step;
+    int m_maxSubsteps;
+    float m_accumulator;
+    float m_droppedTime;
+};
+
+#endif // !FIXED_TIMESTEP_H
@@ -0,0 +1,33 @@
+//  Contains the member functions of LOD_SELECTOR.H
+
+#include "LodSelector.h"
+
+#include <algorithm>
+
+LodSelector::LodSelector(int baseSegments, int levelCount, float maxEdgePixels, float hysteresis) :
+    m_hysteresis(hysteresis)
+{
+    const float PI = 3.14159265359f;
+
+    //  an edge of a sphere with s segments and radius r is 2 pi r / s long,
+    //  the same segment counts as BuildUVSphereLods
+    for (int level = 1; level < levelCount; level++) {
+        int segments = std::max(4, baseSegments >> level);
+        m_coarserBelow.push_back(maxEdgePixels * segments / (2.0f * PI));
+    }
+}
+
+int LodSelector::GetLevelCount() const {
+    return (int)m_coarserBelow.size() + 1;
+}
+
+int LodSelector::Select(float pixelRadius, int current) const {
+    int last = (int)m_coarserBelow.size();
+    int level = std::min(std::max(current, 0), last);
+
+    while (level > 0 && pixelRadius > m_coarserBelow[level - 1] * (1.0f + m_hysteresis))
+        level--;
+    while (level < last && pixelRadius < m_coarserBelow[level] * (1.0f - m_hysteresis))
+        level++;
+    return level;
+}
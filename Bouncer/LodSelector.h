@@ -0,0 +1,38 @@
+#pragma once
+
+#ifndef LOD_SELECTOR_H
+#define LOD_SELECTOR_H
+
+#include <vector>
+
+/*
+    Level of detail of a sphere from its radius on screen
+
+    The levels are the spheres of BuildUVSphereLods, level 0 is the finest
+    and every further level has half the segments. A level is fine enough
+    while an edge around its equator stays within maxEdgePixels on screen.
+
+    A sphere close to the radius where two levels meet would switch back
+    and forth between them as it moves. To avoid this popping, a sphere only
+    moves to a coarser level once its radius is below the switch radius by
+    the hysteresis fraction, and back to a finer level once it is above it
+    by the same fraction. The level of the last frame is kept per object and
+    passed to Select.
+*/
+class LodSelector
+{
+public:
+    LodSelector(int baseSegments, int levelCount, float maxEdgePixels = 3.0f, float hysteresis = 0.15f);
+
+    int GetLevelCount() const;
+
+    //  Level for a sphere with the given radius in pixels that used level current in the last frame
+    int Select(float pixelRadius, int current) const;
+
+private:
+    //  m_coarserBelow[i] is the radius in pixels below which level i + 1 is fine enough
+    std::vector<float> m_coarserBelow;
+    float m_hysteresis;
+};
+
+#endif // !LOD_SELECTOR_H
@@ -0,0 +1,115 @@
+//  Contains the member functions of MESH_REGISTRY.H
+
+#include "MeshRegistry.h"
+
+#include <iostream>
+
+MeshRegistry::MeshRegistry() :
+    m_objectCount(0)
+{
+}
+
+MeshRegistry::~MeshRegistry() {
+    //  nothing to delete once cleared (e.g. before the GL context goes away)
+    Clear();
+}
+
+MeshHandle MeshRegistry::Create(const std::string& name, GLenum mode,
+                                const void* vertices, GLsizei vertexCount, GLsizei stride,
+                                const MeshAttribute* attributes, int attributeCount,
+                                const void* indices, GLsizei indexCount, GLenum indexType) {
+    if (m_names.find(name) != m_names.end()) {
+        std::cout << "ERROR::MESH_REGISTRY::" << name << "::ALREADY_CREATED" << std::endl;
+        return INVALID_MESH;
+    }
+
+    Mesh mesh;
+    mesh.mode = mode;
+    mesh.ebo = 0;
+    mesh.indexType = indexType;
+    mesh.count = indices != NULL ? indexCount : vertexCount;
+
+    glGenVertexArrays(1, &mesh.vao);
+    glGenBuffers(1, &mesh.vbo);
+    m_objectCount += 2;
+
+    glBindVertexArray(mesh.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+    glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertexCount * stride, vertices, GL_STATIC_DRAW);
+
+    if (indices != NULL) {
+        GLsizeiptr indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+        glGenBuffers(1, &mesh.ebo);
+        m_objectCount++;
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * indexSize, indices, GL_STATIC_DRAW);
+    }
+
+    for (int i = 0; i < attributeCount; i++) {
+        const MeshAttribute& attribute = attributes[i];
+        glEnableVertexAttribArray(attribute.location);
+        glVertexAttribPointer(attribute.location, attribute.size, attribute.type, attribute.normalized,
+                              stride, (void*)(size_t)attribute.offset);
+    }
+
+    //  the index buffer binding is part of the vertex array, unbind that first
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    MeshHandle handle = (MeshHandle)m_meshes.size();
+    m_meshes.push_back(mesh);
+    m_names[name] = handle;
+    return handle;
+}
+
+MeshHandle MeshRegistry::Create(const std::string& name, const MeshData& mesh) {
+    const MeshAttribute attributes[] = {
+        { 0, 3, GL_FLOAT, GL_FALSE, VERTEX_POSITION_OFFSET },
+        { 1, 2, GL_FLOAT, GL_FALSE, VERTEX_UV_OFFSET },
+        mesh.format == VERTEX_FLOAT_NORMAL ? MeshAttribute{ 2, 3, GL_FLOAT, GL_FALSE, VERTEX_NORMAL_OFFSET }
+                                           : MeshAttribute{ 2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, VERTEX_NORMAL_OFFSET },
+    };
+    GLenum mode = mesh.primitive == MESH_TRIANGLE_STRIP ? GL_TRIANGLE_STRIP : GL_TRIANGLES;
+    GLenum indexType = mesh.indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+    return Create(name, mode, &mesh.vertices[0], mesh.vertexCount, mesh.GetStride(), attributes, 3,
+                  &mesh.indices[0], mesh.indexCount, indexType);
+}
+
+MeshHandle MeshRegistry::Find(const std::string& name) const {
+    std::unordered_map<std::string, MeshHandle>::const_iterator it = m_names.find(name);
+    return it != m_names.end() ? it->second : INVALID_MESH;
+}
+
+void MeshRegistry::Draw(MeshHandle mesh) const {
+    if (mesh < 0 || mesh >= (MeshHandle)m_meshes.size())
+        return;
+
+    const Mesh& m = m_meshes[mesh];
+    glBindVertexArray(m.vao);
+    if (m.ebo != 0)
+        glDrawElements(m.mode, m.count, m.indexType, 0);
+    else
+        glDrawArrays(m.mode, 0, m.count);
+}
+
+void MeshRegistry::Clear() {
+    for (size_t i = 0; i < m_meshes.size(); i++) {
+        glDeleteVertexArrays(1, &m_meshes[i].vao);
+        glDeleteBuffers(1, &m_meshes[i].vbo);
+        if (m_meshes[i].ebo != 0)
+            glDeleteBuffers(1, &m_meshes[i].ebo);
+    }
+    m_meshes.clear();
+    m_names.clear();
+    m_objectCount = 0;
+}
+
+int MeshRegistry::GetMeshCount() const {
+    return (int)m_meshes.size();
+}
+
+int MeshRegistry::GetObjectCount() const {
+    return m_objectCount;
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#ifndef MESH_REGISTRY_H
+#define MESH_REGISTRY_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "ProceduralMesh.h"
+
+//  Index of a mesh in its registry, INVALID_MESH when there is none
+typedef int MeshHandle;
+const MeshHandle INVALID_MESH = -1;
+
+//  One vertex attribute of an interleaved vertex buffer
+struct MeshAttribute
+{
+    GLuint location;        //  layout (location = ...) in the vertex shader
+    GLint size;             //  components
+    GLenum type;
+    GLboolean normalized;
+    unsigned int offset;    //  bytes from the start of the vertex
+};
+
+/*
+    Owner of the static meshes of the scene
+
+    Each mesh is uploaded once into its own vertex array with a vertex buffer
+    and, when indexed, an index buffer. The registry hands out handles for
+    drawing and deletes the GL objects in Clear, so drawing a mesh never
+    creates anything. GetObjectCount is the number of live GL objects, it
+    must not change from frame to frame once the scene is set up.
+*/
+class MeshRegistry
+{
+public:
+    MeshRegistry();
+    ~MeshRegistry();
+
+    //  Uploads a mesh under a unique name and returns its handle, needs a GL context
+    //  indices may be NULL to draw vertexCount vertices in order,
+    //  indexType is GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    MeshHandle Create(const std::string& name, GLenum mode,
+                      const void* vertices, GLsizei vertexCount, GLsizei stride,
+                      const MeshAttribute* attributes, int attributeCount,
+                      const void* indices = NULL, GLsizei indexCount = 0, GLenum indexType = GL_UNSIGNED_INT);
+
+    //  Uploads a mesh from the procedural mesh library, position at attribute
+    //  0, uv at 1 and normal at 2
+    MeshHandle Create(const std::string& name, const MeshData& mesh);
+
+    //  Handle of the mesh with this name, INVALID_MESH if it was never created
+    MeshHandle Find(const std::string& name) const;
+
+    void Draw(MeshHandle mesh) const;
+
+    //  Deletes every mesh, handles become invalid
+    void Clear();
+
+    int GetMeshCount() const;
+    //  Vertex arrays and buffers currently owned
+    int GetObjectCount() const;
+
+private:
+    struct Mesh
+    {
+        GLuint vao;
+        GLuint vbo;
+        GLuint ebo;         //  0 when the mesh is not indexed
+        GLenum mode;
+        GLsizei count;      //  indices, or vertices when not indexed
+        GLenum indexType;
+    };
+
+    std::vector<Mesh> m_meshes;
+    std::unordered_map<std::string, MeshHandle> m_names;
+    int m_objectCount;
+};
+
+#endif // !MESH_REGISTRY_H
@@ -0,0 +1,175 @@
+/*
+    Implementation of PERFORMANCE_OVERLAY_H
+*/
+
+#include "PerformanceOverlay.h"
+
+#include <glad/glad.h>
+#include <glfw/glfw3.h>
+#include <imgui.h>
+#include <imgui_impl_glfw_gl3.h>
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <unistd.h>
+#endif
+
+PerformanceOverlay::PerformanceOverlay() :
+    m_window(NULL), m_initialized(false), m_visible(true), m_toggleHeld(false), m_frameIndex(0),
+    m_simulationTime(0.0f), m_renderTime(0.0f), m_stepCount(0), m_stepWindow(0.0f), m_stepRate(0.0f),
+    m_liveCount(0), m_capacity(0)
+{
+    std::fill(m_frameTimes, m_frameTimes + OVERLAY_FRAME_HISTORY, 0.0f);
+}
+
+void PerformanceOverlay::Init(GLFWwindow* window)
+{
+    m_window = window;
+
+    //  the application keeps its own mouse callbacks and forwards to OnMouseButton and OnScroll,
+    //  the keyboard is only used by the overlay
+    ImGui_ImplGlfwGL3_Init(window, false);
+    glfwSetKeyCallback(window, ImGui_ImplGlfwGL3_KeyCallback);
+    glfwSetCharCallback(window, ImGui_ImplGlfwGL3_CharCallback);
+    ImGui::GetIO().IniFilename = NULL;
+    m_initialized = true;
+}
+
+void PerformanceOverlay::Shutdown()
+{
+    if (!m_initialized)
+        return;
+    ImGui_ImplGlfwGL3_Shutdown();
+    m_initialized = false;
+}
+
+void PerformanceOverlay::NewFrame(float frameTime)
+{
+    //  F1 toggles on the press, not on every frame it is held
+    bool toggle = glfwGetKey(m_window, GLFW_KEY_F1) == GLFW_PRESS;
+    if (toggle && !m_toggleHeld)
+        m_visible = !m_visible;
+    m_toggleHeld = toggle;
+
+    m_frameTimes[m_frameIndex] = frameTime * 1000.0f;
+    m_frameIndex = (m_frameIndex + 1) % OVERLAY_FRAME_HISTORY;
+
+    m_stepWindow += frameTime;
+    if (m_stepWindow >= 1.0f) {
+        m_stepRate = m_stepCount / m_stepWindow;
+        m_stepCount = 0;
+        m_stepWindow = 0.0f;
+    }
+
+    ImGui_ImplGlfwGL3_NewFrame();
+}
+
+void PerformanceOverlay::SetSimulation(float milliseconds, int steps)
+{
+    m_simulationTime = milliseconds;
+    m_stepCount += steps;
+}
+
+void PerformanceOverlay::SetRenderTime(float milliseconds)
+{
+    m_renderTime = milliseconds;
+}
+
+void PerformanceOverlay::SetBodyCount(int live, int capacity)
+{
+    m_liveCount = live;
+    m_capacity = capacity;
+}
+
+bool PerformanceOverlay::Draw(OverlayControls& controls)
+{
+    bool changed = false;
+
+    if (m_visible) {
+        ImGui::SetNextWindowPos(ImVec2(10.0f, 10.0f), ImGuiSetCond_FirstUseEver);
+        ImGui::Begin("Performance (F1)", NULL, ImGuiWindowFlags_AlwaysAutoResize);
+
+        //  frame times, oldest first
+        float average = 0.0f, worst = 0.0f;
+        for (int i = 0; i < OVERLAY_FRAME_HISTORY; i++) {
+            average += m_frameTimes[i];
+            worst = std::max(worst, m_frameTimes[i]);
+        }
+        average /= OVERLAY_FRAME_HISTORY;
+        ImGui::Text("Frame %.2f ms (%.0f fps), worst %.2f ms", average, average > 0.0f ? 1000.0f / average : 0.0f, worst);
+        ImGui::PlotHistogram("##frames", m_frameTimes, OVERLAY_FRAME_HISTORY, m_frameIndex, NULL, 0.0f, std::max(33.3f, worst), ImVec2(300.0f, 60.0f));
+
+        //  share of the frame spent simulating and rendering
+        float busy = m_simulationTime + m_renderTime;
+        char label[64];
+        snprintf(label, sizeof(label), "Simulation %.2f ms", m_simulationTime);
+        ImGui::ProgressBar(busy > 0.0f ? m_simulationTime / busy : 0.0f, ImVec2(300.0f, 0.0f), label);
+        snprintf(label, sizeof(label), "Render %.2f ms", m_renderTime);
+        ImGui::ProgressBar(busy > 0.0f ? m_renderTime / busy : 0.0f, ImVec2(300.0f, 0.0f), label);
+
+        ImGui::Text("Steps/sec %.0f", m_stepRate);
+        ImGui::Text("Live %d of %d", m_liveCount, m_capacity);
+        ImGui::Text("Memory %.1f MB", GetProcessMemoryUsage() / (1024.0 * 1024.0));
+
+        ImGui::Separator();
+        if (controls.count != NULL)
+            changed |= ImGui::SliderInt(controls.countLabel, controls.count, 0, controls.maxCount);
+        if (controls.threads != NULL)
+            changed |= ImGui::SliderInt("Threads", controls.threads, 1, controls.maxThreads);
+        if (controls.timestep != NULL)
+            changed |= ImGui::SliderFloat("Timestep", controls.timestep, 0.001f, 0.05f, "%.4f s", 2.0f);
+
+        ImGui::End();
+    }
+
+    ImGui::Render();
+    return changed;
+}
+
+void PerformanceOverlay::OnMouseButton(GLFWwindow* window, int button, int action, int mods)
+{
+    if (m_initialized)
+        ImGui_ImplGlfwGL3_MouseButtonCallback(window, button, action, mods);
+}
+
+void PerformanceOverlay::OnScroll(GLFWwindow* window, double x_offSet, double y_offSet)
+{
+    if (m_initialized)
+        ImGui_ImplGlfwGL3_ScrollCallback(window, x_offSet, y_offSet);
+}
+
+bool PerformanceOverlay::WantsMouse() const
+{
+    return m_initialized && m_visible && ImGui::GetIO().WantCaptureMouse;
+}
+
+bool PerformanceOverlay::IsVisible() const
+{
+    return m_visible;
+}
+
+unsigned long long GetProcessMemoryUsage()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.WorkingSetSize;
+    return 0;
+#else
+    //  second field of statm is the resident set, in pages
+    unsigned long long size = 0, resident = 0;
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (file == NULL)
+        return 0;
+    if (fscanf(file, "%llu %llu", &size, &resident) != 2)
+        resident = 0;
+    fclose(file);
+    return resident * (unsigned long long)sysconf(_SC_PAGESIZE);
+#endif
+}
@@ -0,0 +1,481 @@
+//  Contains the functions of PROCEDURAL_MESH.H
+
+#include "ProceduralMesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    const float PI = 3.14159265359f;
+
+    inline uint32_t PackComponent(float c, int shift)
+    {
+        //  no branches, the signs of the normals of a mesh are mixed and would mispredict
+        //  rounds to nearest, away from zero at halves
+        c = std::min(1.0f, std::max(-1.0f, c));
+        int value = (int)(c * 511.0f + std::copysign(0.5f, c));
+        return ((uint32_t)value & 0x3FF) << shift;
+    }
+
+    //  Writes the vertices of an allocated mesh one after the other
+    struct VertexWriter
+    {
+        unsigned char* out;
+        int stride;
+        bool packed;
+
+        explicit VertexWriter(MeshData& mesh) :
+            out(mesh.vertices.empty() ? NULL : &mesh.vertices[0]), stride(mesh.GetStride()), packed(mesh.format == VERTEX_PACKED_NORMAL)
+        {
+        }
+
+        inline void Write(float px, float py, float pz, float u, float v, float nx, float ny, float nz)
+        {
+            if (!packed) {
+                const float attributes[8] = { px, py, pz, u, v, nx, ny, nz };
+                memcpy(out, attributes, sizeof(attributes));
+            }
+            else {
+                const float attributes[5] = { px, py, pz, u, v };
+                uint32_t normal = PackComponent(nx, 0) | PackComponent(ny, 10) | PackComponent(nz, 20);
+                memcpy(out, attributes, sizeof(attributes));
+                memcpy(out + VERTEX_NORMAL_OFFSET, &normal, sizeof(normal));
+            }
+            out += stride;
+        }
+    };
+
+    //  Index writers, instantiated for 16 and 32 bit indices
+    template <class Index>
+    void WriteUVSphereIndices(Index* out, int xSegments, int ySegments)
+    {
+        int n = 0;
+        for (int y = 0; y < ySegments; ++y) {
+            //  even rows run forwards and odd rows back, so the strip never jumps
+            if (y % 2 == 0) {
+                for (int x = 0; x <= xSegments; ++x) {
+                    out[n++] = (Index)((y + 1) * (xSegments + 1) + x);
+                    out[n++] = (Index)(y       * (xSegments + 1) + x);
+                }
+            }
+            else {
+                for (int x = xSegments; x >= 0; --x) {
+                    out[n++] = (Index)(y       * (xSegments + 1) + x);
+                    out[n++] = (Index)((y + 1) * (xSegments + 1) + x);
+                }
+            }
+        }
+    }
+
+    const uint64_t EMPTY_EDGE = ~0ull;
+
+    //  Midpoints of the edges split by one subdivision of the icosphere,
+    //  open addressing on the two end vertices of the edge
+    struct EdgeTable
+    {
+        std::vector<uint64_t> keys;
+        std::vector<uint32_t> midpoints;
+        size_t mask;
+
+        //  empties the table for up to edges edges, reusing its storage
+        void Reset(int edges)
+        {
+            size_t size = 16;
+            while (size < (size_t)edges * 2)
+                size *= 2;
+            keys.assign(size, EMPTY_EDGE);
+            midpoints.resize(size);
+            mask = size - 1;
+        }
+
+        //  slot of the edge from a to b, claimed for it when the edge is new
+        bool Find(uint32_t a, uint32_t b, size_t& slot)
+        {
+            uint64_t key = a < b ? ((uint64_t)a << 32) | b : ((uint64_t)b << 32) | a;
+            slot = (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+            while (keys[slot] != EMPTY_EDGE) {
+                if (keys[slot] == key)
+                    return true;
+                slot = (slot + 1) & mask;
+            }
+            keys[slot] = key;
+            return false;
+        }
+    };
+
+    //  one per thread, so rebuilding an icosphere allocates nothing
+    thread_local EdgeTable icosphereEdges;
+
+    /*
+        Writes the 20 faces of the icosahedron to the index buffer and splits
+        them in 4 the given number of times, the midpoints are appended to
+        the positions of the 12 vertices at the start of the vertex buffer
+        Triangles are split from the last one back, so the 4 children of a
+        triangle never overwrite one that is still to be split.
+    */
+    template <class Index>
+    void SubdivideIcosphere(MeshData& mesh, Index* triangles, const uint32_t* faces, int subdivisions, EdgeTable& edges)
+    {
+        for (int i = 0; i < 20 * 3; i++)
+            triangles[i] = (Index)faces[i];
+
+        unsigned char* vertices = &mesh.vertices[0];
+        int stride = mesh.GetStride();
+        uint32_t vertexCount = 12;
+        int triangleCount = 20;
+
+        for (int s = 0; s < subdivisions; s++) {
+            edges.Reset(triangleCount * 3 / 2);
+            for (int f = triangleCount - 1; f >= 0; f--) {
+                const uint32_t corner[3] = { triangles[f * 3], triangles[f * 3 + 1], triangles[f * 3 + 2] };
+                uint32_t middle[3];
+                for (int e = 0; e < 3; e++) {
+                    uint32_t a = corner[e];
+                    uint32_t b = corner[(e + 1) % 3];
+                    size_t slot;
+                    if (!edges.Find(a, b, slot)) {
+                        const float* pa = (const float*)(vertices + a * stride);
+                        const float* pb = (const float*)(vertices + b * stride);
+                        float mx = pa[0] + pb[0];
+                        float my = pa[1] + pb[1];
+                        float mz = pa[2] + pb[2];
+                        float length = std::sqrt(mx * mx + my * my + mz * mz);
+                        float* position = (float*)(vertices + vertexCount * stride);
+                        position[0] = mx / length;
+                        position[1] = my / length;
+                        position[2] = mz / length;
+                        edges.midpoints[slot] = vertexCount++;
+                    }
+                    middle[e] = edges.midpoints[slot];
+                }
+
+                //  the corners keep their winding, the middle triangle joins the new vertices
+                Index* children = triangles + f * 12;
+                children[0] = (Index)corner[0];  children[1] = (Index)middle[0];  children[2] = (Index)middle[2];
+                children[3] = (Index)middle[0];  children[4] = (Index)corner[1];  children[5] = (Index)middle[1];
+                children[6] = (Index)middle[2];  children[7] = (Index)middle[1];  children[8] = (Index)corner[2];
+                children[9] = (Index)middle[0];  children[10] = (Index)middle[1]; children[11] = (Index)middle[2];
+            }
+            triangleCount *= 4;
+        }
+    }
+
+    template <class Index>
+    void WriteBoxIndices(Index* out)
+    {
+        for (int face = 0; face < 6; face++) {
+            Index first = (Index)(face * 4);
+            out[face * 6 + 0] = first;
+            out[face * 6 + 1] = (Index)(first + 1);
+            out[face * 6 + 2] = (Index)(first + 2);
+            out[face * 6 + 3] = first;
+            out[face * 6 + 4] = (Index)(first + 2);
+            out[face * 6 + 5] = (Index)(first + 3);
+        }
+    }
+
+    template <class Index>
+    void WritePlaneIndices(Index* out, int xSegments, int zSegments)
+    {
+        int n = 0;
+        for (int z = 0; z < zSegments; z++) {
+            for (int x = 0; x < xSegments; x++) {
+                int corner = z * (xSegments + 1) + x;
+                int below = corner + xSegments + 1;
+                out[n++] = (Index)below;
+                out[n++] = (Index)(below + 1);
+                out[n++] = (Index)(corner + 1);
+                out[n++] = (Index)below;
+                out[n++] = (Index)(corner + 1);
+                out[n++] = (Index)corner;
+            }
+        }
+    }
+
+    //  side vertices alternate bottom and top, then the top cap and the
+    //  bottom cap each start with their centre
+    template <class Index>
+    void WriteCylinderIndices(Index* out, int segments)
+    {
+        int n = 0;
+        for (int i = 0; i < segments; i++) {
+            int bottom = 2 * i;
+            out[n++] = (Index)bottom;
+            out[n++] = (Index)(bottom + 1);
+            out[n++] = (Index)(bottom + 2);
+            out[n++] = (Index)(bottom + 2);
+            out[n++] = (Index)(bottom + 1);
+            out[n++] = (Index)(bottom + 3);
+        }
+
+        int top = 2 * (segments + 1);
+        int bottom = top + segments + 2;
+        for (int i = 0; i < segments; i++) {
+            out[n++] = (Index)top;
+            out[n++] = (Index)(top + 2 + i);
+            out[n++] = (Index)(top + 1 + i);
+        }
+        for (int i = 0; i < segments; i++) {
+            out[n++] = (Index)bottom;
+            out[n++] = (Index)(bottom + 1 + i);
+            out[n++] = (Index)(bottom + 2 + i);
+        }
+    }
+}
+
+int GetVertexStride(VertexFormat format) {
+    return format == VERTEX_FLOAT_NORMAL ? 8 * sizeof(float) : 5 * sizeof(float) + sizeof(uint32_t);
+}
+
+uint32_t PackNormal(float x, float y, float z) {
+    return PackComponent(x, 0) | PackComponent(y, 10) | PackComponent(z, 20);
+}
+
+void UnpackNormal(uint32_t packed, float& x, float& y, float& z) {
+    float components[3];
+    for (int i = 0; i < 3; i++) {
+        //  sign extend the 10 bit field
+        int value = (int)((packed >> (10 * i)) & 0x3FF);
+        if (value & 0x200)
+            value -= 0x400;
+        components[i] = std::max(-1.0f, value / 511.0f);
+    }
+    x = components[0];
+    y = components[1];
+    z = components[2];
+}
+
+MeshData::MeshData() :
+    primitive(MESH_TRIANGLES), format(VERTEX_FLOAT_NORMAL), vertexCount(0), indexCount(0), indexSize(2)
+{
+}
+
+void MeshData::Allocate(MeshPrimitive primitive, VertexFormat format, int vertexCount, int indexCount) {
+    this->primitive = primitive;
+    this->format = format;
+    this->vertexCount = vertexCount;
+    this->indexCount = indexCount;
+    this->indexSize = vertexCount <= 65536 ? 2 : 4;
+
+    //  resize keeps the capacity, a mesh rebuilt at the same size reuses its buffers
+    vertices.resize((size_t)vertexCount * GetStride());
+    indices.resize((size_t)indexCount * indexSize);
+}
+
+int MeshData::GetStride() const {
+    return GetVertexStride(format);
+}
+
+const float* MeshData::GetPosition(int vertex) const {
+    return (const float*)(&vertices[0] + vertex * GetStride() + VERTEX_POSITION_OFFSET);
+}
+
+const float* MeshData::GetUV(int vertex) const {
+    return (const float*)(&vertices[0] + vertex * GetStride() + VERTEX_UV_OFFSET);
+}
+
+void MeshData::GetNormal(int vertex, float& x, float& y, float& z) const {
+    const unsigned char* normal = &vertices[0] + vertex * GetStride() + VERTEX_NORMAL_OFFSET;
+    if (format == VERTEX_FLOAT_NORMAL) {
+        float n[3];
+        memcpy(n, normal, sizeof(n));
+        x = n[0];
+        y = n[1];
+        z = n[2];
+    }
+    else {
+        uint32_t packed;
+        memcpy(&packed, normal, sizeof(packed));
+        UnpackNormal(packed, x, y, z);
+    }
+}
+
+unsigned int MeshData::GetIndex(int index) const {
+    if (indexSize == 2) {
+        uint16_t value;
+        memcpy(&value, &indices[index * 2], sizeof(value));
+        return value;
+    }
+    uint32_t value;
+    memcpy(&value, &indices[index * 4], sizeof(value));
+    return value;
+}
+
+void BuildUVSphere(MeshData& mesh, int xSegments, int ySegments, VertexFormat format) {
+    mesh.Allocate(MESH_TRIANGLE_STRIP, format, (xSegments + 1) * (ySegments + 1), ySegments * (xSegments + 1) * 2);
+
+    VertexWriter vertex(mesh);
+    for (int y = 0; y <= ySegments; ++y) {
+        float ySegment = (float)y / (float)ySegments;
+        float ringRadius = std::sin(ySegment * PI);
+        float yPos = std::cos(ySegment * PI);
+        for (int x = 0; x <= xSegments; ++x) {
+            float xSegment = (float)x / (float)xSegments;
+            float xPos = std::cos(xSegment * 2.0f * PI) * ringRadius;
+            float zPos = std::sin(xSegment * 2.0f * PI) * ringRadius;
+
+            //  the normal is the same as the position on a unit sphere
+            vertex.Write(xPos, yPos, zPos, xSegment, ySegment, xPos, yPos, zPos);
+        }
+    }
+
+    if (mesh.indexSize == 2)
+        WriteUVSphereIndices((uint16_t*)&mesh.indices[0], xSegments, ySegments);
+    else
+        WriteUVSphereIndices((uint32_t*)&mesh.indices[0], xSegments, ySegments);
+}
+
+/*
+    Every subdivision puts a new vertex on the middle of each edge, pushed
+    out onto the sphere, and replaces each triangle with 4. The vertex on an
+    edge is shared by the two triangles of that edge through a table keyed
+    by the pair of end points.
+*/
+void BuildIcosphere(MeshData& mesh, int subdivisions, VertexFormat format) {
+    const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+    const float corners[12][3] = {
+        { -1.0f,  t, 0.0f }, {  1.0f,  t, 0.0f }, { -1.0f, -t, 0.0f }, {  1.0f, -t, 0.0f },
+        { 0.0f, -1.0f,  t }, { 0.0f,  1.0f,  t }, { 0.0f, -1.0f, -t }, { 0.0f,  1.0f, -t },
+        {  t, 0.0f, -1.0f }, {  t, 0.0f,  1.0f }, { -t, 0.0f, -1.0f }, { -t, 0.0f,  1.0f }
+    };
+    const uint32_t faces[20 * 3] = {
+        0, 11, 5,   0, 5, 1,    0, 1, 7,    0, 7, 10,   0, 10, 11,
+        1, 5, 9,    5, 11, 4,   11, 10, 2,  10, 7, 6,   7, 1, 8,
+        3, 9, 4,    3, 4, 2,    3, 2, 6,    3, 6, 8,    3, 8, 9,
+        4, 9, 5,    2, 4, 11,   6, 2, 10,   8, 6, 7,    9, 8, 1
+    };
+
+    int finalVertices = 2;
+    int finalTriangles = 20;
+    for (int s = 0; s < subdivisions; s++)
+        finalTriangles *= 4;
+    finalVertices += finalTriangles / 2;
+
+    //  the positions and triangles are built up in place in the mesh buffers
+    mesh.Allocate(MESH_TRIANGLES, format, finalVertices, finalTriangles * 3);
+    int stride = mesh.GetStride();
+    for (int i = 0; i < 12; i++) {
+        float length = std::sqrt(corners[i][0] * corners[i][0] + corners[i][1] * corners[i][1] + corners[i][2] * corners[i][2]);
+        float* position = (float*)(&mesh.vertices[0] + i * stride);
+        position[0] = corners[i][0] / length;
+        position[1] = corners[i][1] / length;
+        position[2] = corners[i][2] / length;
+    }
+
+    if (mesh.indexSize == 2) {
+        uint16_t* triangles = (uint16_t*)&mesh.indices[0];
+        SubdivideIcosphere(mesh, triangles, faces, subdivisions, icosphereEdges);
+    }
+    else {
+        uint32_t* triangles = (uint32_t*)&mesh.indices[0];
+        SubdivideIcosphere(mesh, triangles, faces, subdivisions, icosphereEdges);
+    }
+
+    //  uv and normal of every vertex from its position
+    VertexWriter vertex(mesh);
+    for (int v = 0; v < finalVertices; v++) {
+        const float* position = mesh.GetPosition(v);
+        float x = position[0];
+        float y = position[1];
+        float z = position[2];
+
+        //  same mapping as the UV sphere, x = cos(2 pi u) sin(pi v), y = cos(pi v)
+        float u = std::atan2(z, x) / (2.0f * PI);
+        if (u < 0.0f)
+            u += 1.0f;
+        float vCoord = std::acos(std::min(1.0f, std::max(-1.0f, y))) / PI;
+        vertex.Write(x, y, z, u, vCoord, x, y, z);
+    }
+}
+
+void BuildBox(MeshData& mesh, VertexFormat format) {
+    //  normal, then the directions of u and v on the face, u x v = normal
+    const float faces[6][9] = {
+        {  1.0f,  0.0f,  0.0f,   0.0f, 0.0f, -1.0f,   0.0f, 1.0f,  0.0f },     //  right
+        { -1.0f,  0.0f,  0.0f,   0.0f, 0.0f,  1.0f,   0.0f, 1.0f,  0.0f },     //  left
+        {  0.0f,  1.0f,  0.0f,   1.0f, 0.0f,  0.0f,   0.0f, 0.0f, -1.0f },     //  top
+        {  0.0f, -1.0f,  0.0f,   1.0f, 0.0f,  0.0f,   0.0f, 0.0f,  1.0f },     //  bottom
+        {  0.0f,  0.0f,  1.0f,   1.0f, 0.0f,  0.0f,   0.0f, 1.0f,  0.0f },     //  front
+        {  0.0f,  0.0f, -1.0f,  -1.0f, 0.0f,  0.0f,   0.0f, 1.0f,  0.0f }      //  back
+    };
+    const float quad[4][2] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+
+    mesh.Allocate(MESH_TRIANGLES, format, 24, 36);
+    VertexWriter vertex(mesh);
+    for (int face = 0; face < 6; face++) {
+        const float* n = faces[face];
+        const float* u = faces[face] + 3;
+        const float* v = faces[face] + 6;
+        for (int corner = 0; corner < 4; corner++) {
+            float su = quad[corner][0] * 2.0f - 1.0f;
+            float sv = quad[corner][1] * 2.0f - 1.0f;
+            vertex.Write(n[0] + su * u[0] + sv * v[0], n[1] + su * u[1] + sv * v[1], n[2] + su * u[2] + sv * v[2],
+                         quad[corner][0], quad[corner][1], n[0], n[1], n[2]);
+        }
+    }
+
+    if (mesh.indexSize == 2)
+        WriteBoxIndices((uint16_t*)&mesh.indices[0]);
+    else
+        WriteBoxIndices((uint32_t*)&mesh.indices[0]);
+}
+
+void BuildPlane(MeshData& mesh, int xSegments, int zSegments, VertexFormat format) {
+    mesh.Allocate(MESH_TRIANGLES, format, (xSegments + 1) * (zSegments + 1), xSegments * zSegments * 6);
+
+    VertexWriter vertex(mesh);
+    for (int z = 0; z <= zSegments; z++) {
+        float zSegment = (float)z / (float)zSegments;
+        for (int x = 0; x <= xSegments; x++) {
+            float xSegment = (float)x / (float)xSegments;
+            vertex.Write(xSegment * 2.0f - 1.0f, 0.0f, zSegment * 2.0f - 1.0f, xSegment, zSegment, 0.0f, 1.0f, 0.0f);
+        }
+    }
+
+    if (mesh.indexSize == 2)
+        WritePlaneIndices((uint16_t*)&mesh.indices[0], xSegments, zSegments);
+    else
+        WritePlaneIndices((uint32_t*)&mesh.indices[0], xSegments, zSegments);
+}
+
+void BuildCylinder(MeshData& mesh, int segments, VertexFormat format) {
+    mesh.Allocate(MESH_TRIANGLES, format, 2 * (segments + 1) + 2 * (segments + 2), 12 * segments);
+
+    //  side, the seam has its own pair of vertices to close the uv
+    VertexWriter vertex(mesh);
+    for (int i = 0; i <= segments; i++) {
+        float u = (float)i / (float)segments;
+        float c = std::cos(u * 2.0f * PI);
+        float s = std::sin(u * 2.0f * PI);
+        vertex.Write(c, -1.0f, s, u, 0.0f, c, 0.0f, s);
+        vertex.Write(c,  1.0f, s, u, 1.0f, c, 0.0f, s);
+    }
+
+    //  caps, top then bottom, a centre and a ring each
+    for (int cap = 0; cap < 2; cap++) {
+        float y = cap == 0 ? 1.0f : -1.0f;
+        vertex.Write(0.0f, y, 0.0f, 0.5f, 0.5f, 0.0f, y, 0.0f);
+        for (int i = 0; i <= segments; i++) {
+            float angle = (float)i / (float)segments * 2.0f * PI;
+            float c = std::cos(angle);
+            float s = std::sin(angle);
+            vertex.Write(c, y, s, 0.5f + 0.5f * c, 0.5f + 0.5f * s, 0.0f, y, 0.0f);
+        }
+    }
+
+    if (mesh.indexSize == 2)
+        WriteCylinderIndices((uint16_t*)&mesh.indices[0], segments);
+    else
+        WriteCylinderIndices((uint32_t*)&mesh.indices[0], segments);
+}
+
+void BuildUVSphereLods(std::vector<MeshData>& lods, int baseSegments, int levelCount, VertexFormat format) {
+    lods.resize(levelCount);
+    for (int level = 0; level < levelCount; level++) {
+        int segments = std::max(4, baseSegments >> level);
+        BuildUVSphere(lods[level], segments, segments, format);
+    }
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#ifndef PROCEDURAL_MESH_H
+#define PROCEDURAL_MESH_H
+
+#include <stdint.h>
+#include <vector>
+
+//  Layout of the interleaved vertices, position and uv come first in both
+enum VertexFormat
+{
+    VERTEX_FLOAT_NORMAL,    //  position (3 floats), uv (2 floats), normal (3 floats), 32 bytes
+    VERTEX_PACKED_NORMAL    //  position (3 floats), uv (2 floats), normal as signed normalized 10:10:10:2, 24 bytes
+};
+
+enum MeshPrimitive
+{
+    MESH_TRIANGLES,
+    MESH_TRIANGLE_STRIP
+};
+
+//  Byte offsets of the attributes within a vertex
+const int VERTEX_POSITION_OFFSET = 0;
+const int VERTEX_UV_OFFSET = 3 * sizeof(float);
+const int VERTEX_NORMAL_OFFSET = 5 * sizeof(float);
+
+int GetVertexStride(VertexFormat format);
+
+//  x in bits 0-9, y in 10-19, z in 20-29, w = 0, as GL_INT_2_10_10_10_REV
+uint32_t PackNormal(float x, float y, float z);
+void UnpackNormal(uint32_t packed, float& x, float& y, float& z);
+
+/*
+    Geometry of one mesh, ready to upload
+
+    Vertices are interleaved in the given format and indices are 16 bit when
+    every vertex can be addressed with them, 32 bit otherwise. Allocate sizes
+    both buffers once for the final counts and the builders write straight
+    into them, so rebuilding a mesh of the same size allocates nothing.
+*/
+struct MeshData
+{
+    MeshPrimitive primitive;
+    VertexFormat format;
+    int vertexCount;
+    int indexCount;
+    int indexSize;                      //  bytes per index, 2 or 4
+    std::vector<unsigned char> vertices;
+    std::vector<unsigned char> indices;
+
+    MeshData();
+
+    void Allocate(MeshPrimitive primitive, VertexFormat format, int vertexCount, int indexCount);
+    int GetStride() const;
+
+    //  Reading back, for checks and tests
+    const float* GetPosition(int vertex) const;
+    const float* GetUV(int vertex) const;
+    void GetNormal(int vertex, float& x, float& y, float& z) const;
+    unsigned int GetIndex(int index) const;
+};
+
+/*
+    Builders of unit shapes centred on the origin
+    Triangles wind counter-clockwise seen from outside and normals point
+    outwards. None of them needs a GL context.
+*/
+
+//  Sphere of radius 1 from a grid of xSegments around the equator by
+//  ySegments from pole to pole, as one triangle strip running back and forth
+void BuildUVSphere(MeshData& mesh, int xSegments, int ySegments, VertexFormat format = VERTEX_FLOAT_NORMAL);
+
+//  Sphere of radius 1 from an icosahedron whose faces are split in 4 the
+//  given number of times, 10 * 4^n + 2 vertices spread evenly over the
+//  surface. The uv are a spherical projection and wrap across one seam.
+void BuildIcosphere(MeshData& mesh, int subdivisions, VertexFormat format = VERTEX_FLOAT_NORMAL);
+
+//  Cube from -1 to 1, 4 vertices per face so every face has its own normal and uv
+void BuildBox(MeshData& mesh, VertexFormat format = VERTEX_FLOAT_NORMAL);
+
+//  Square from -1 to 1 in the xz plane facing +y, xSegments by zSegments quads
+void BuildPlane(MeshData& mesh, int xSegments, int zSegments, VertexFormat format = VERTEX_FLOAT_NORMAL);
+
+//  Cylinder of radius 1 along y from -1 to 1 with segments around it and both caps
+void BuildCylinder(MeshData& mesh, int segments, VertexFormat format = VERTEX_FLOAT_NORMAL);
+
+//  Levels of detail of the UV sphere, level 0 has baseSegments around the
+//  equator and every further level half as many, but never fewer than 4
+void BuildUVSphereLods(std::vector<MeshData>& lods, int baseSegments, int levelCount, VertexFormat format = VERTEX_FLOAT_NORMAL);
+
+#endif // !PROCEDURAL_MESH_H
@@ -0,0 +1,195 @@
+/*
+    Implementation of PROFILER_H
+*/
+
+#include "Profiler.h"
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace
+{
+    //  Zones per block of a thread buffer, and blocks a thread may fill
+    const int PROFILER_BLOCK_EVENTS = 4096;
+    const int PROFILER_MAX_BLOCKS = 256;
+
+    struct ProfileEvent
+    {
+        const char* name;
+        unsigned long long start;
+        unsigned long long duration;
+    };
+
+    /*
+        Zones of one thread, in a chain of fixed size blocks
+
+        Only the owning thread writes. It fills an event and then publishes
+        it by raising the block count, a reader that loads the count sees
+        every event below it complete, so the trace can be written while
+        other threads keep recording. Blocks are never moved or freed.
+    */
+    struct EventBlock
+    {
+        ProfileEvent events[PROFILER_BLOCK_EVENTS];
+        std::atomic<int> count;
+        std::atomic<EventBlock*> next;
+
+        EventBlock() : count(0), next(NULL) {}
+    };
+
+    struct ThreadBuffer
+    {
+        EventBlock* first;
+        EventBlock* current;
+        int blocks;
+        std::atomic<int> dropped;
+        int id;
+        std::string name;       //  guarded by the registry mutex
+
+        ThreadBuffer(int threadId) : first(new EventBlock()), current(first), blocks(1), dropped(0), id(threadId) {}
+    };
+
+    //  Every thread buffer ever created, buffers outlive their threads so the trace keeps their zones
+    std::mutex registryMutex;
+    std::vector<ThreadBuffer*> registry;
+
+    thread_local ThreadBuffer* localBuffer = NULL;
+
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    ThreadBuffer* GetLocalBuffer()
+    {
+        if (localBuffer == NULL) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            localBuffer = new ThreadBuffer((int)registry.size());
+            registry.push_back(localBuffer);
+        }
+        return localBuffer;
+    }
+
+    //  Writes a string literal, escaping what JSON requires
+    void WriteJsonString(std::ofstream& file, const char* text)
+    {
+        file << '"';
+        for (const char* c = text; *c != '\0'; c++) {
+            if (*c == '"' || *c == '\\')
+                file << '\\';
+            file << *c;
+        }
+        file << '"';
+    }
+}
+
+unsigned long long Profiler::Now()
+{
+    return (unsigned long long)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::Record(const char* name, unsigned long long start, unsigned long long end)
+{
+    ThreadBuffer* buffer = GetLocalBuffer();
+    EventBlock* block = buffer->current;
+
+    int n = block->count.load(std::memory_order_relaxed);
+    if (n == PROFILER_BLOCK_EVENTS) {
+        if (buffer->blocks == PROFILER_MAX_BLOCKS) {
+            buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        EventBlock* next = new EventBlock();
+        block->next.store(next, std::memory_order_release);
+        buffer->current = next;
+        buffer->blocks++;
+        block = next;
+        n = 0;
+    }
+
+    ProfileEvent& e = block->events[n];
+    e.name = name;
+    e.start = start;
+    e.duration = end - start;
+    block->count.store(n + 1, std::memory_order_release);
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+    ThreadBuffer* buffer = GetLocalBuffer();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffer->name = name;
+}
+
+int Profiler::GetEventCount()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    int count = 0;
+    for (size_t t = 0; t < registry.size(); t++)
+        for (EventBlock* block = registry[t]->first; block != NULL; block = block->next.load(std::memory_order_acquire))
+            count += block->count.load(std::memory_order_acquire);
+    return count;
+}
+
+int Profiler::GetDroppedCount()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    int count = 0;
+    for (size_t t = 0; t < registry.size(); t++)
+        count += registry[t]->dropped.load(std::memory_order_relaxed);
+    return count;
+}
+
+bool Profiler::WriteChromeTrace(const char* path)
+{
+    if (!PROFILER_ENABLED)
+        std::cout << "Profiler zones are compiled out, build the Profile configuration to record them" << std::endl;
+
+    std::ofstream file(path);
+    if (!file) {
+        std::cout << "Failed to open trace file " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    int written = 0, dropped = 0;
+
+    //  trace event timestamps are in microseconds, three decimals keep the nanoseconds
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool firstEvent = true;
+    for (size_t t = 0; t < registry.size(); t++) {
+        const ThreadBuffer* buffer = registry[t];
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+
+        if (!buffer->name.empty()) {
+            file << (firstEvent ? "\n" : ",\n");
+            file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id << ",\"args\":{\"name\":";
+            WriteJsonString(file, buffer->name.c_str());
+            file << "}}";
+            firstEvent = false;
+        }
+
+        for (EventBlock* block = buffer->first; block != NULL; block = block->next.load(std::memory_order_acquire)) {
+            int count = block->count.load(std::memory_order_acquire);
+            for (int i = 0; i < count; i++) {
+                const ProfileEvent& e = block->events[i];
+                file << (firstEvent ? "\n" : ",\n");
+                file << "{\"name\":";
+                WriteJsonString(file, e.name);
+                file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->id
+                     << ",\"ts\":" << e.start / 1000.0 << ",\"dur\":" << e.duration / 1000.0 << "}";
+                firstEvent = false;
+            }
+            written += count;
+        }
+    }
+    file << "\n]}\n";
+
+    std::cout << "Trace of " << written << " zones written to " << path << std::endl;
+    if (dropped > 0)
+        std::cout << dropped << " zones were dropped, the thread buffers were full" << std::endl;
+    return true;
+}
@@ -1,10 +1,12 @@
 //  Contains all the member functions of SHADER.H
 
 #include "Shader.h"
+#include "Profiler.h"
 
 // loading vertex and fragment shaders
 void Shader::LoadShader(const GLchar* vertexPath, const GLchar* fragmentPath)
 {
+    PROFILE_SCOPE("Shader::LoadShader");
     //retrieve the vertex and fragment source code from the address path
     string vertexCode;
     string fragmentCode;
@@ -80,6 +82,7 @@ void Shader::LoadShader(const GLchar* vertexPath, const GLchar* fragmentPath)
         glGetProgramInfoLog(this->Program, 512, NULL, infoLog);
         cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED" << endl << infoLog << endl;
     }
+    LoadUniforms();
 
     //delete the shader resources as they are no longer required
     glDeleteShader(vertex);
@@ -90,43 +93,137 @@ void Shader::Use()
 {
     glUseProgram(this->Program);
 }
+/*
+    Builds the table of uniform locations once after linking, so setting a
+    uniform by name is a hash lookup instead of a glGetUniformLocation call
+    Arrays are listed as name[0] and also stored under their plain name,
+    uniforms in blocks have no location and are left out
+*/
+void Shader::LoadUniforms()
+{
+    m_uniforms.clear();
+
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(this->Program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(this->Program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::string name(maxLength > 0 ? maxLength : 1, '\0');
+    for (GLint i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(this->Program, (GLuint)i, maxLength, &length, &size, &type, &name[0]);
+
+        std::string uniformName(name.c_str(), length);
+        GLint location = glGetUniformLocation(this->Program, uniformName.c_str());
+        if (location < 0)
+            continue;
+
+        m_uniforms[uniformName] = location;
+        size_t bracket = uniformName.find("[0]");
+        if (bracket != std::string::npos && bracket + 3 == uniformName.size())
+        {
+            //  arrays are listed once as name[0], every element gets its own
+            //  entry, queried since their locations need not be consecutive
+            std::string arrayName = uniformName.substr(0, bracket);
+            m_uniforms[arrayName] = location;
+            for (GLint element = 1; element < size; element++)
+            {
+                std::string elementName = arrayName + "[" + std::to_string(element) + "]";
+                GLint elementLocation = glGetUniformLocation(this->Program, elementName.c_str());
+                if (elementLocation >= 0)
+                    m_uniforms[elementName] = elementLocation;
+            }
+        }
+    }
+}
+GLint Shader::GetUniform(const std::string &name) const
+{
+    std::unordered_map<std::string, GLint>::const_iterator it = m_uniforms.find(name);
+    return it != m_uniforms.end() ? it->second : -1;
+}
+int Shader::GetUniformCount() const
+{
+    return (int)m_uniforms.size();
+}
 void Shader::SetBool(const std::string &name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(this->Program, name.c_str()), (int)value);
+    glUniform1i(GetUniform(name), (int)value);
 }
 void Shader::SetInt(const std::string &name, int value) const
 {
-    glUniform1i(glGetUniformLocation(this->Program, name.c_str()), value);
+    glUniform1i(GetUniform(name), value);
 }
 void Shader::SetFloat(const std::string &name, float value) const
 {
-    glUniform1f(glGetUniformLocation(this->Program, name.c_str()), value);
+    glUniform1f(GetUniform(name), value);
 }
 void Shader::SetVec2(const std::string &name, const glm::vec2 &value) const
 {
-    glUniform2fv(glGetUniformLocation(this->Program, name.c_str()), 1, &value[0]);
+    glUniform2fv(GetUniform(name), 1, &value[0]);
 }
 void Shader::SetVec2(const std::string &name, float x, float y) const
 {
-    glUniform2f(glGetUniformLocation(this->Program, name.c_str()), x, y);
+    glUniform2f(GetUniform(name), x, y);
 }
 void Shader::SetVec3(const std::string &name, const glm::vec3 &value) const
 {
-    glUniform3fv(glGetUniformLocation(this->Program, name.c_str()), 1, &value[0]);
+    glUniform3fv(GetUniform(name), 1, &value[0]);
 }
 void Shader::SetVec3(const std::string &name, float x, float y, float z) const
 {
-    glUniform3f(glGetUniformLocation(this->Program, name.c_str()), x, y, z);
+    glUniform3f(GetUniform(name), x, y, z);
 }
 void Shader::SetMat2(const std::string &name, const glm::mat2 &mat) const
 {
-    glUniformMatrix2fv(glGetUniformLocation(this->Program, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix2fv(GetUniform(name), 1, GL_FALSE, &mat[0][0]);
 }
 void Shader::SetMat3(const std::string &name, const glm::mat3 &mat) const
 {
-    glUniformMatrix3fv(glGetUniformLocation(this->Program, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix3fv(GetUniform(name), 1, GL_FALSE, &mat[0][0]);
 }
 void Shader::SetMat4(const std::string &name, const glm::mat4 &mat) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(this->Program, name.c_str()), 1, GL_FALSE, &mat[0][0]);
-}
\ No newline at end of file
+    glUniformMatrix4fv(GetUniform(name), 1, GL_FALSE, &mat[0][0]);
+}
+void Shader::SetBool(GLint location, bool value) const
+{
+    glUniform1i(location, (int)value);
+}
+void Shader::SetInt(GLint location, int value) const
+{
+    glUniform1i(location, value);
+}
+void Shader::SetFloat(GLint location, float value) const
+{
+    glUniform1f(location, value);
+}
+void Shader::SetVec2(GLint location, const glm::vec2 &value) const
+{
+    glUniform2fv(location, 1, &value[0]);
+}
+void Shader::SetVec2(GLint location, float x, float y) const
+{
+    glUniform2f(location, x, y);
+}
+void Shader::SetVec3(GLint location, const glm::vec3 &value) const
+{
+    glUniform3fv(location, 1, &value[0]);
+}
+void Shader::SetVec3(GLint location, float x, float y, float z) const
+{
+    glUniform3f(location, x, y, z);
+}
+void Shader::SetMat2(GLint location, const glm::mat2 &mat) const
+{
+    glUniformMatrix2fv(location, 1, GL_FALSE, &mat[0][0]);
+}
+void Shader::SetMat3(GLint location, const glm::mat3 &mat) const
+{
+    glUniformMatrix3fv(location, 1, GL_FALSE, &mat[0][0]);
+}
+void Shader::SetMat4(GLint location, const glm::mat4 &mat) const
+{
+    glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
+}
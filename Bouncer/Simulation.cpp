@@ -2,9 +2,8 @@
 
 
 //  Global Variables
-std::vector<glm::vec3> planePositions(6);   //  DS to store plane positions and normals used for collision detection
-std::vector<glm::vec3> planeNormals(6);
-std::vector<bool> collisionPlane(6, false);
+ColliderSet walls;                          //  walls of the box, used for collision detection
+const float ballRadius = 1.25f;             //  collision radius of the ball
 
 
 void StartSimulation(glm::vec3 ballPosition) {
@@ -31,6 +30,7 @@ Information stored in the following manner
 [5] ->  -Z  ->  BACK
 */
 void ConfigurePlanes() {
+    glm::vec3 planePositions[6];
     planePositions[0] = glm::vec3(15.0f, 0.0, 0.0);
     planePositions[1] = glm::vec3(-15.0f, 0.0, 0.0);
     planePositions[2] = glm::vec3(0.0, 15.0f, 0.0);
@@ -38,13 +38,19 @@ void ConfigurePlanes() {
     planePositions[4] = glm::vec3(0.0, 0.0, 15.0f);
     planePositions[5] = glm::vec3(0.0, 0.0, -15.0f);
 
+    //  normals point into the box
+    walls.Clear();
     glm::vec3 negative(-1.0);
-    planeNormals[0] = glm::normalize(planePositions[0]) * negative;
-    planeNormals[1] = glm::normalize(planePositions[1]) * negative;
-    planeNormals[2] = glm::normalize(planePositions[2]) * negative;
-    planeNormals[3] = glm::normalize(planePositions[3]) * negative;
-    planeNormals[4] = glm::normalize(planePositions[4]) * negative;
-    planeNormals[5] = glm::normalize(planePositions[5]) * negative;
+    for (int i = 0; i < 6; i++)
+        walls.AddPlane(planePositions[i], glm::normalize(planePositions[i]) * negative);
+}
+
+const ColliderSet& GetWalls() {
+    return walls;
+}
+
+float GetBallRadius() {
+    return ballRadius;
 }
 
 /*
@@ -68,7 +74,8 @@ glm::vec3 UpdatePosition(glm::vec3 ballPosition) {
     glm::vec3 windVelocity = glm::vec3(-4.0f, 0.0f, 0.0f);      //  wind velocity
 
     //  Calculating acceleration taking into account gravity and air resistance
-    glm::vec3 acceleration = gravity + (airResistanceConstant / mass)*(windVelocity - velocity);
+    const auto forces = Gravity(gravity) + Wind(windVelocity, airResistanceConstant / mass);
+    glm::vec3 acceleration = Acceleration(forces, ballPosition, velocity);
     //  Euler simulation
     glm::vec3 newVelocity = velocity + acceleration*h;
     glm::vec3 newPosition = ballPosition + h*((newVelocity + velocity) / 2.0f);
@@ -96,64 +103,66 @@ glm::vec3 UpdatePosition(glm::vec3 ballPosition) {
     Checks for collisions with the walls of the cube and returns true if collision occurs
 */
 bool CollisionCheck(glm::vec3 position) {
-    //std::cout << position.x << " " << position.y << " " << position.z << std::endl;
-    float radius = 1.25f;
-    
-    for (int i = 0; i < planePositions.size(); i++) {
-        glm::vec3 difference = position - planePositions[i];
-        //std::cout << "Diff: " << difference.x <<" "<<difference.y<<" "<<difference.z << std::endl;
-        float dotProd = glm::dot(difference, planeNormals[i]);
-        //std::cout << dotProd << std::endl;
-        float distance = dotProd - radius;
-        //std::cout << distance << std::endl;
-
-        if (distance < 0) {
-            collisionPlane[i] = true;
-            return true;
-        }
-    }
-    
-    //  if not returned from for loop, return false since no collision detected
-    return false;
+    PROFILE_SCOPE("CollisionCheck");
+    float depth;
+    return walls.Test(position, ballRadius, depth) >= 0;
 }
 
+/*
+    Distance from the surface of the ball to the nearest wall, negative when inside it
+*/
 float FindDistance(glm::vec3 position) {
+    PROFILE_SCOPE("FindDistance");
     float distance = FLT_MAX;
-    float radius = 1.25f;
-
-    for (int i = 0; i < planePositions.size(); i++) {
-        glm::vec3 difference = position - planePositions[i];
-        //std::cout << "Diff: " << difference.x <<" "<<difference.y<<" "<<difference.z << std::endl;
-        float dotProd = glm::dot(difference, planeNormals[i]);
-        //std::cout << dotProd << std::endl;
-        float newDistance = dotProd - radius;
-        //std::cout << distance << std::endl;
 
+    for (int i = 0; i < walls.GetPlaneCount(); i++) {
+        float newDistance = glm::dot(position, walls.GetNormal(i)) - walls.GetOffset(i) - ballRadius;
         distance = std::min(distance, newDistance);
     }
 
     return distance;
 }
 
-glm::vec3 CollisionResponse(glm::vec3 velocity) {
-    int planeIndex = 0;
-    float coe = 1.0f;       //  Coefficient of Elasticity
-    float cof = 0.1f;       //  Coefficient of Friction
-    
-    //  Find the right plane where collision takes place
-    for (int i = 0; i < collisionPlane.size(); i++) {
-        if (collisionPlane[i]) {
-            planeIndex = i;
-            break;
+/*
+    Finds the first wall the ball hits when moving from position to newPosition
+    For every wall the ball ends up inside, the fraction of the move at which
+    it touches the wall is estimated from the distances before and after,
+        fraction = dCurrent / (dCurrent - dNext)
+    The earliest of them is returned and plane set to its wall, or plane set
+    to -1 when the ball touches no wall at newPosition
+*/
+float FindImpactFraction(glm::vec3 position, glm::vec3 newPosition, int& plane) {
+    PROFILE_SCOPE("FindImpactFraction");
+    float fraction = 1.0f;
+    plane = -1;
+
+    for (int i = 0; i < walls.GetPlaneCount(); i++) {
+        glm::vec3 normal = walls.GetNormal(i);
+        float dNext = glm::dot(newPosition, normal) - walls.GetOffset(i) - ballRadius;
+        if (dNext >= 0.0f)
+            continue;
+
+        //  a ball that already touches the wall hits it right away
+        float dCurrent = glm::dot(position, normal) - walls.GetOffset(i) - ballRadius;
+        float newFraction = dCurrent > 0.0f ? dCurrent / (dCurrent - dNext) : 0.0f;
+        if (plane < 0 || newFraction < fraction) {
+            fraction = newFraction;
+            plane = i;
         }
     }
-    glm::vec3 normal = planeNormals[planeIndex];
-    /*
-    std::cout << "Collision Response" << std::endl;
-    std::cout << "Plane: " << planePositions[planeIndex].x << " " << planePositions[planeIndex].y << " " << planePositions[planeIndex].z << std::endl;
-    std::cout << "Plane: " << planeNormals[planeIndex].x << " " << planeNormals[planeIndex].y << " " << planeNormals[planeIndex].z << std::endl;
-    std::cout << "CR IV: " << velocity.x << " " << velocity.y << " " << velocity.z << std::endl;
-    */
+
+    return fraction;
+}
+
+/*
+    Velocity of the ball after bouncing off the given wall
+*/
+glm::vec3 CollisionResponse(glm::vec3 velocity, int plane) {
+    PROFILE_SCOPE("CollisionResponse");
+    float coe = 1.0f;       //  Coefficient of Elasticity
+    float cof = 0.1f;       //  Coefficient of Friction
+
+    glm::vec3 normal = walls.GetNormal(plane);
     //  Calculate normal and tangential velocity
     glm::vec3 normalVelocity = dot(velocity, normal) * normal;
     //std::cout << "normal V: " << normalVelocity.x << " " << normalVelocity.y << " " << normalVelocity.z << std::endl;
@@ -169,7 +178,29 @@ glm::vec3 CollisionResponse(glm::vec3 velocity) {
 
     //std::cout << "Out V: " << newVelocity.x<<" "<<newVelocity.y<<" "<<newVelocity.z << std::endl;
 
-    collisionPlane[planeIndex] = false;
-
     return newVelocity;
-}
\ No newline at end of file
+}
+
+/*
+    Pushes the ball out of every wall it sinks into and bounces it off the
+    walls it is still moving into
+*/
+void KeepBallInside(glm::vec3& position, glm::vec3& velocity) {
+    for (int i = 0; i < walls.GetPlaneCount(); i++) {
+        glm::vec3 normal = walls.GetNormal(i);
+        float distance = glm::dot(position, normal) - walls.GetOffset(i) - ballRadius;
+        if (distance < 0.0f) {
+            position -= distance * normal;
+            if (glm::dot(velocity, normal) < 0.0f)
+                velocity = CollisionResponse(velocity, i);
+        }
+    }
+}
+
+/*
+    Advances the ball by one timestep h under a constant acceleration and
+    resolves collisions with the walls of the box
+*/
+void StepBall(glm::vec3& position, glm::vec3& velocity, float h, const glm::vec3& acceleration) {
+    StepBall<VelocityVerlet>(position, velocity, h, Gravity(acceleration));
+}
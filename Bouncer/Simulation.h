@@ -10,6 +10,10 @@
 #include <algorithm>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include "ColliderSet.h"
+#include "ForceField.h"
+#include "Integrator.h"
+#include "Profiler.h"
 
 //  Function prototypes
 void StartSimulation(glm::vec3 ballPosition);
@@ -17,6 +21,106 @@ void ConfigurePlanes();
 glm::vec3 UpdatePosition(glm::vec3 ballPosition);
 bool CollisionCheck(glm::vec3 position);
 float FindDistance(glm::vec3 position);
-glm::vec3 CollisionResponse(glm::vec3 velocity);
+glm::vec3 CollisionResponse(glm::vec3 velocity, int plane);
+void KeepBallInside(glm::vec3& position, glm::vec3& velocity);
+const ColliderSet& GetWalls();
+float GetBallRadius();
+void StepBall(glm::vec3& position, glm::vec3& velocity, float h, const glm::vec3& acceleration);
+float FindImpactFraction(glm::vec3 position, glm::vec3 newPosition, int& plane);
+
+//  Most wall impacts resolved within one step, a ball wedged in a corner
+//  flies the rest of the step freely and is put back inside the box
+const int MAX_IMPACTS_PER_STEP = 4;
+
+/*
+    Steps the ball under a set of force fields, see ForceField.h, with one
+    of the integrators of Integrator.h
+
+    Continuous collision detection: when the end of the step lies inside a
+    wall, the time of impact is estimated from the distances to that wall
+    before and after the step, see FindImpactFraction, the ball is advanced
+    to that point, bounced with CollisionResponse and
+    the remaining part of the step is integrated from there, which may hit
+    another wall. A fast ball cannot pass through a wall between two steps.
+    A ball already touching a wall only bounces if it is moving into it;
+    one resting on or leaving the wall, or past MAX_IMPACTS_PER_STEP,
+    takes the whole rest of the step and is pushed back by KeepBallInside.
+*/
+template <class Integrator = VelocityVerlet, class Forces>
+void StepBall(glm::vec3& position, glm::vec3& velocity, float h, const Forces& forces) {
+    PROFILE_SCOPE("StepBall");
+    float remaining = h;
+
+    for (int impact = 0; remaining > 0.0f; impact++) {
+        glm::vec3 newPosition = position;
+        glm::vec3 newVelocity = velocity;
+        Integrate<Integrator>(forces, remaining, newPosition, newVelocity);
+
+        int plane;
+        float fraction = FindImpactFraction(position, newPosition, plane);
+        if (plane < 0) {
+            //  free flight for the rest of the step
+            position = newPosition;
+            velocity = newVelocity;
+            return;
+        }
+        if (impact == MAX_IMPACTS_PER_STEP || (fraction == 0.0f && glm::dot(velocity, GetWalls().GetNormal(plane)) >= 0.0f)) {
+            position = newPosition;
+            velocity = newVelocity;
+            KeepBallInside(position, velocity);
+            return;
+        }
+
+        //  advance to the time of impact
+        float hImpact = fraction * remaining;
+        if (hImpact > 0.0f)
+            Integrate<Integrator>(forces, hImpact, position, velocity);
+
+        velocity = CollisionResponse(velocity, plane);
+        remaining -= hImpact;
+    }
+}
+
+/*
+    Advances the ball by duration seconds with adaptive steps, see AdaptiveStep
+    Each trial step is taken with StepBall once whole and once in two
+    halves, so an impact inside the step counts towards the error like the
+    forces do. Returns the number of accepted steps.
+*/
+template <class Integrator = VelocityVerlet, class Forces>
+int AdvanceBall(glm::vec3& position, glm::vec3& velocity, float duration, const Forces& forces, AdaptiveStep& adaptive) {
+    int steps = 0;
+    float remaining = duration;
+
+    while (remaining > 1.0e-6f * duration) {
+        float h = std::min(adaptive.step, remaining);
+        bool clipped = h < adaptive.step;
+        float proposed = adaptive.step;
+
+        glm::vec3 wholePosition = position;
+        glm::vec3 wholeVelocity = velocity;
+        StepBall<Integrator>(wholePosition, wholeVelocity, h, forces);
+
+        glm::vec3 halfPosition = position;
+        glm::vec3 halfVelocity = velocity;
+        StepBall<Integrator>(halfPosition, halfVelocity, 0.5f * h, forces);
+        StepBall<Integrator>(halfPosition, halfVelocity, 0.5f * h, forces);
+
+        //  position and velocity error, the latter as the distance it makes up over the step
+        float difference = std::max(glm::length(halfPosition - wholePosition), h * glm::length(halfVelocity - wholeVelocity));
+        if (adaptive.Update(h, AdaptiveStep::DoublingError(difference, Integrator::Order), Integrator::Order)) {
+            position = halfPosition;
+            velocity = halfVelocity;
+            remaining -= h;
+            steps++;
+
+            //  a step cut short by the end of the interval says nothing about the next one
+            if (clipped)
+                adaptive.step = std::max(adaptive.step, proposed);
+        }
+    }
+
+    return steps;
+}
 
 #endif // !SIMULATION_H
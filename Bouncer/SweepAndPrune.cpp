@@ -0,0 +1,93 @@
+//  Contains the member functions of SWEEP_AND_PRUNE.H
+
+#include "SweepAndPrune.h"
+
+#include <algorithm>
+#include <cmath>
+
+SweepAndPrune::SweepAndPrune() :
+    m_axis(0), m_swapCount(0)
+{
+}
+
+void SweepAndPrune::SetAxis(int axis) {
+    axis = axis < 0 ? 0 : (axis > 2 ? 2 : axis);
+    //  the order along another axis has nothing in common with the current one
+    if (axis != m_axis)
+        m_order.clear();
+    m_axis = axis;
+}
+
+int SweepAndPrune::GetAxis() const {
+    return m_axis;
+}
+
+void SweepAndPrune::Update(const float* x, const float* y, const float* z, const float* radius, int count) {
+    const float* key = m_axis == 0 ? x : (m_axis == 1 ? y : z);
+    const float* other1 = m_axis == 0 ? y : x;
+    const float* other2 = m_axis == 2 ? y : z;
+
+    //  bodies added since the last update go at the end, removed ones are dropped
+    bool resized = (int)m_order.size() != count;
+    if (resized) {
+        std::vector<Endpoint> kept;
+        kept.reserve(count);
+        for (size_t k = 0; k < m_order.size(); k++)
+            if (m_order[k].body < count)
+                kept.push_back(m_order[k]);
+        for (int i = (int)m_order.size(); i < count; i++) {
+            Endpoint e = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, i };
+            kept.push_back(e);
+        }
+        m_order.swap(kept);
+    }
+
+    //  refresh the intervals in the old order
+    for (int k = 0; k < count; k++) {
+        int i = m_order[k].body;
+        m_order[k].lower = key[i] - radius[i];
+        m_order[k].upper = key[i] + radius[i];
+        m_order[k].centre1 = other1[i];
+        m_order[k].centre2 = other2[i];
+        m_order[k].radius = radius[i];
+    }
+
+    //  insertion sort, nearly linear when the bodies moved little
+    //  new bodies can be anywhere, so after a resize the order is sorted from scratch
+    m_swapCount = 0;
+    if (resized)
+        std::sort(m_order.begin(), m_order.end(), [](const Endpoint& a, const Endpoint& b) { return a.lower < b.lower; });
+    for (int k = 1; k < count; k++) {
+        Endpoint e = m_order[k];
+        int j = k - 1;
+        while (j >= 0 && m_order[j].lower > e.lower) {
+            m_order[j + 1] = m_order[j];
+            j--;
+        }
+        m_swapCount += k - 1 - j;
+        m_order[j + 1] = e;
+    }
+
+    //  sweep, a body only meets the bodies that start before it ends
+    m_pairs.clear();
+    for (int k = 0; k < count; k++) {
+        const Endpoint& e = m_order[k];
+        for (int m = k + 1; m < count && m_order[m].lower <= e.upper; m++) {
+            const Endpoint& f = m_order[m];
+            float reach = e.radius + f.radius;
+            if (std::fabs(e.centre1 - f.centre1) > reach || std::fabs(e.centre2 - f.centre2) > reach)
+                continue;
+
+            BroadphasePair pair = { e.body, f.body };
+            m_pairs.push_back(pair);
+        }
+    }
+}
+
+const std::vector<BroadphasePair>& SweepAndPrune::GetPairs() const {
+    return m_pairs;
+}
+
+int SweepAndPrune::GetSwapCount() const {
+    return m_swapCount;
+}
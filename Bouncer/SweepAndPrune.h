@@ -0,0 +1,64 @@
+#pragma once
+
+#ifndef SWEEP_AND_PRUNE_H
+#define SWEEP_AND_PRUNE_H
+
+#include <vector>
+
+//  Two bodies whose bounding boxes overlap
+struct BroadphasePair
+{
+    int a;
+    int b;
+};
+
+/*
+    Sweep and prune broadphase for spheres
+
+    The bodies are kept sorted by the lower end of their bounding interval
+    along one axis. A sweep over that order only compares each body with the
+    ones that start before it ends, and only those whose boxes also overlap on
+    the other two axes are reported as pairs.
+
+    Bodies move little from one step to the next, so the order from the last
+    update is almost sorted already and is repaired with an insertion sort,
+    which is linear for a nearly sorted list. The whole update is then close
+    to linear in the number of bodies plus the number of overlaps.
+*/
+class SweepAndPrune
+{
+public:
+    SweepAndPrune();
+
+    //  Sorting axis, 0 = x, 1 = y, 2 = z
+    void SetAxis(int axis);
+    int GetAxis() const;
+
+    //  Re-sorts bodies [0, count) with centres (x, y, z) and radii r and collects the overlapping pairs
+    void Update(const float* x, const float* y, const float* z, const float* radius, int count);
+
+    const std::vector<BroadphasePair>& GetPairs() const;
+
+    //  Insertion sort swaps of the last update, low while the order stays coherent
+    int GetSwapCount() const;
+
+private:
+    //  a body in sweep order, with its interval on the sorting axis and its
+    //  centre on the other two, so the sweep reads memory in order
+    struct Endpoint
+    {
+        float lower;
+        float upper;
+        float centre1;
+        float centre2;
+        float radius;
+        int body;
+    };
+
+    int m_axis;
+    std::vector<Endpoint> m_order;
+    std::vector<BroadphasePair> m_pairs;
+    int m_swapCount;
+};
+
+#endif // !SWEEP_AND_PRUNE_H
@@ -1,9 +1,11 @@
 //  Contains member functions of TEXTURE.H
 
 #include "Texture.h"
+#include "Profiler.h"
 
 GLuint Texture::LoadTexture(GLchar* path, std::string name)
 {
+    PROFILE_SCOPE("Texture::LoadTexture");
     this->m_name = name;
     // Generate texture ID and load texture data 
     glGenTextures(1, &this->m_texID);
@@ -27,6 +29,7 @@ GLuint Texture::LoadTexture(GLchar* path, std::string name)
 
 GLuint Texture::LoadHDR(GLchar* path, std::string name)
 {
+    PROFILE_SCOPE("Texture::LoadHDR");
     this->m_name = name;
     this->m_texType = GL_TEXTURE_2D;
 
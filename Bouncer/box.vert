@@ -5,8 +5,12 @@ layout (location = 1) in vec2 in_tex_coords;
 out vec2 out_tex_coords;
 
 uniform mat4 model;
-uniform mat4 projection;
-uniform mat4 view;
+
+// camera matrices, shared by all programs and written once per frame
+layout (std140, binding = 0) uniform Camera {
+	mat4 projection;
+	mat4 view;
+};
 
 void main(){
 	vec3 world_pos = vec3(model * vec4(pos,1.0));
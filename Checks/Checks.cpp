@@ -0,0 +1,123 @@
+/*
+Checks.cpp
+Headless correctness checks of the simulation building blocks
+C++
+Needs no window or GL context, prints every failure and returns non-zero
+when any check fails, so it can gate a build
+*/
+
+//  C++ headers
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+//  Custom headers
+#include "Integrator.h"
+#include "ThreadPool.h"
+
+bool CheckThreadPoolResize();
+bool CheckAdaptiveStepNaN();
+
+int main(int argc, char** argv) {
+
+    //  Command line
+    //  --filter NAME   only run the checks whose name contains NAME
+    const char* filter = "";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else
+            std::cout << "Ignoring unknown argument " << argv[i] << std::endl;
+    }
+
+    struct Check {
+        const char* name;
+        bool (*run)();
+    };
+    const Check checks[] = {
+        { "ThreadPool/Resize", CheckThreadPoolResize },
+        { "AdaptiveStep/NaN", CheckAdaptiveStepNaN }
+    };
+
+    int failed = 0;
+    for (int c = 0; c < (int)(sizeof(checks) / sizeof(checks[0])); c++) {
+        if (strstr(checks[c].name, filter) == NULL)
+            continue;
+        bool passed = checks[c].run();
+        std::cout << (passed ? "PASS " : "FAIL ") << checks[c].name << std::endl;
+        if (!passed)
+            failed++;
+    }
+
+    return failed > 0 ? 1 : 0;
+}
+
+/*
+    Runs ParallelFor on one pool resized up and down between jobs
+    Every index of every job must be visited exactly once and the results
+    must match those of the serial pool
+*/
+bool CheckThreadPoolResize() {
+    const int threadCounts[] = { 4, 1, 3, 8, 2, 8, 5 };
+    const int counts[] = { 1, 7, 64, 1000 };
+    const int chunkSizes[] = { 1, 3, 16 };
+
+    ThreadPool serial(1);
+    ThreadPool pool(2);
+    for (int t = 0; t < (int)(sizeof(threadCounts) / sizeof(threadCounts[0])); t++) {
+        pool.SetThreadCount(threadCounts[t]);
+        for (int c = 0; c < (int)(sizeof(counts) / sizeof(counts[0])); c++) {
+            for (int k = 0; k < (int)(sizeof(chunkSizes) / sizeof(chunkSizes[0])); k++) {
+                int count = counts[c];
+                std::vector<int> visits(count, 0);
+                std::vector<float> expected(count, 0.0f);
+                std::vector<float> result(count, 0.0f);
+
+                serial.ParallelFor(count, chunkSizes[k], [&](int begin, int end) {
+                    for (int i = begin; i < end; i++)
+                        expected[i] = i * 0.5f + begin;
+                });
+                pool.ParallelFor(count, chunkSizes[k], [&](int begin, int end) {
+                    for (int i = begin; i < end; i++) {
+                        visits[i]++;
+                        result[i] = i * 0.5f + begin;
+                    }
+                });
+
+                for (int i = 0; i < count; i++) {
+                    if (visits[i] != 1 || result[i] != expected[i]) {
+                        std::cout << "ThreadPool with " << threadCounts[t] << " threads: index " << i << " of " << count
+                            << " in chunks of " << chunkSizes[k] << " ran " << visits[i] << " times" << std::endl;
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/*
+    A NaN error must shrink the trial step down to minStep, where it is
+    accepted, instead of growing it and rejecting it forever
+*/
+bool CheckAdaptiveStepNaN() {
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    AdaptiveStep adaptive(1.0e-3f, 1.0e-4f, 0.1f);
+    adaptive.step = 0.01f;
+
+    for (int trial = 0; trial < 100; trial++) {
+        float h = adaptive.step;
+        if (adaptive.Update(h, nan, VelocityVerlet::Order)) {
+            if (h != adaptive.minStep) {
+                std::cout << "AdaptiveStep accepted a NaN error at h = " << h << " above minStep" << std::endl;
+                return false;
+            }
+            return true;
+        }
+    }
+
+    std::cout << "AdaptiveStep still rejects a NaN error after 100 trials, step = " << adaptive.step << std::endl;
+    return false;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#ifndef COLLIDER_SET_H
+#define COLLIDER_SET_H
+
+#include <glm/glm.hpp>
+#include <vector>
+
+//  Bodies per tile of the batch kernel, the tile's positions and results stay in L1
+const int COLLIDER_TILE_SIZE = 256;
+
+/*
+    Set of static planes that spheres collide with
+
+    A plane is stored as its unit normal n, pointing to the side the bodies
+    stay on, and its offset d = dot(n, point), one array per component. A
+    sphere of radius r centred at p penetrates the plane by
+        depth = r - (dot(n, p) - d)
+    when depth > 0.
+
+    The batch kernel tests many bodies against every plane with no branches
+    and no shared state: for each tile of bodies it walks the planes and
+    keeps, per body, the deepest penetration and the plane it belongs to.
+    The inner loop runs over bodies, so the compiler vectorizes it with one
+    body per SIMD lane.
+*/
+class ColliderSet
+{
+public:
+    ColliderSet();
+
+    //  Adds the plane through point with the given normal, returns its index
+    int AddPlane(const glm::vec3& point, const glm::vec3& normal);
+    void Clear();
+
+    int GetPlaneCount() const;
+    glm::vec3 GetNormal(int plane) const;
+    float GetOffset(int plane) const;
+
+    /*
+        Tests spheres [0, count) of radius r against every plane
+        depth[i] is the deepest penetration of sphere i, 0 when it touches
+        nothing, and plane[i] the plane of that contact, -1 when there is none
+    */
+    void Test(const float* x, const float* y, const float* z, int count, float radius, float* depth, int* plane) const;
+
+    //  Test for spheres of different sizes, sphere i has radius[i]
+    void Test(const float* x, const float* y, const float* z, const float* radius, int count, float* depth, int* plane) const;
+
+    //  Single sphere version of Test, returns the contact plane or -1
+    int Test(const glm::vec3& position, float radius, float& depth) const;
+
+    /*
+        Tests spheres [0, count) and resolves their contacts: a sphere inside
+        a plane is pushed back onto it and the normal part of its velocity,
+        when moving into the plane, is reflected and scaled by restitution,
+        the tangential part is scaled by 1 - friction
+    */
+    void Resolve(float* x, float* y, float* z, float* vx, float* vy, float* vz, int count,
+                 float radius, float restitution, float friction) const;
+
+    //  Resolve for spheres of different sizes, sphere i has radius[i]
+    void Resolve(float* x, float* y, float* z, float* vx, float* vy, float* vz, const float* radius, int count,
+                 float restitution, float friction) const;
+
+private:
+    template <class Radius>
+    void TestBatch(const float* x, const float* y, const float* z, Radius radius, int count, float* depth, int* plane) const;
+    template <class Radius>
+    void ResolveBatch(float* x, float* y, float* z, float* vx, float* vy, float* vz, Radius radius, int count,
+                      float restitution, float friction) const;
+
+    std::vector<float> m_nx;
+    std::vector<float> m_ny;
+    std::vector<float> m_nz;
+    std::vector<float> m_d;
+};
+
+#endif // !COLLIDER_SET_H
@@ -0,0 +1,210 @@
+#pragma once
+#ifndef FORCE_FIELD_H
+#define FORCE_FIELD_H
+
+#include <cmath>
+#include <glm/glm.hpp>
+
+/*
+    Force fields that are composed at compile time
+
+    Every field has an Apply function that adds its acceleration at position
+    (x, y, z) and velocity (vx, vy, vz) to (ax, ay, az). Fields are combined
+    with operator+,
+
+        Gravity(g) + LinearDrag(0.1f) + Attractor(center, 50.0f)
+
+    which builds a ForceSum type whose Apply calls both sides directly. The
+    whole set is inlined into the update loop, so any combination of forces
+    is evaluated in a single pass over the particles with no virtual calls.
+
+    All fields work on accelerations, coefficients that depend on the mass
+    are expected to be divided by it already.
+*/
+
+//  Base of every field, only used to restrict operator+ to force fields
+template <class Derived>
+struct ForceField
+{
+    const Derived& Self() const { return static_cast<const Derived&>(*this); }
+};
+
+//  Sum of two force fields, built by operator+
+template <class A, class B>
+struct ForceSum : ForceField<ForceSum<A, B> >
+{
+    A a;
+    B b;
+
+    ForceSum(const A& first, const B& second) : a(first), b(second) {}
+
+    inline void Apply(float x, float y, float z, float vx, float vy, float vz,
+                      float& ax, float& ay, float& az) const
+    {
+        a.Apply(x, y, z, vx, vy, vz, ax, ay, az);
+        b.Apply(x, y, z, vx, vy, vz, ax, ay, az);
+    }
+};
+
+template <class A, class B>
+inline ForceSum<A, B> operator+(const ForceField<A>& a, const ForceField<B>& b)
+{
+    return ForceSum<A, B>(a.Self(), b.Self());
+}
+
+//  Constant acceleration, a = g
+struct Gravity : ForceField<Gravity>
+{
+    float gx, gy, gz;
+
+    explicit Gravity(const glm::vec3& g) : gx(g.x), gy(g.y), gz(g.z) {}
+
+    inline void Apply(float, float, float, float, float, float,
+                      float& ax, float& ay, float& az) const
+    {
+        ax += gx;
+        ay += gy;
+        az += gz;
+    }
+};
+
+//  Drag proportional to the velocity, a = -k v
+struct LinearDrag : ForceField<LinearDrag>
+{
+    float k;
+
+    explicit LinearDrag(float coefficient) : k(coefficient) {}
+
+    inline void Apply(float, float, float, float vx, float vy, float vz,
+                      float& ax, float& ay, float& az) const
+    {
+        ax -= k * vx;
+        ay -= k * vy;
+        az -= k * vz;
+    }
+};
+
+//  Drag proportional to the square of the speed, a = -k |v| v
+struct QuadraticDrag : ForceField<QuadraticDrag>
+{
+    float k;
+
+    explicit QuadraticDrag(float coefficient) : k(coefficient) {}
+
+    inline void Apply(float, float, float, float vx, float vy, float vz,
+                      float& ax, float& ay, float& az) const
+    {
+        float s = k * std::sqrt(vx * vx + vy * vy + vz * vz);
+        ax -= s * vx;
+        ay -= s * vy;
+        az -= s * vz;
+    }
+};
+
+//  Air moving at a constant velocity w that drags bodies along, a = k (w - v)
+struct Wind : ForceField<Wind>
+{
+    float wx, wy, wz;
+    float k;
+
+    Wind(const glm::vec3& velocity, float coefficient)
+        : wx(velocity.x), wy(velocity.y), wz(velocity.z), k(coefficient) {}
+
+    inline void Apply(float, float, float, float vx, float vy, float vz,
+                      float& ax, float& ay, float& az) const
+    {
+        ax += k * (wx - vx);
+        ay += k * (wy - vy);
+        az += k * (wz - vz);
+    }
+};
+
+/*
+    Pulls towards a point with an inverse square falloff, negative strength repels
+    a = s d / (|d|^2 + e^2)^(3/2),  d = center - x
+    The softening length e keeps the pull finite at the center
+*/
+struct Attractor : ForceField<Attractor>
+{
+    float cx, cy, cz;
+    float strength;
+    float softening2;
+
+    Attractor(const glm::vec3& center, float s, float softening = 0.1f)
+        : cx(center.x), cy(center.y), cz(center.z), strength(s), softening2(softening * softening) {}
+
+    inline void Apply(float x, float y, float z, float, float, float,
+                      float& ax, float& ay, float& az) const
+    {
+        float dx = cx - x;
+        float dy = cy - y;
+        float dz = cz - z;
+        float r2 = dx * dx + dy * dy + dz * dz + softening2;
+        float s = strength / (r2 * std::sqrt(r2));
+        ax += s * dx;
+        ay += s * dy;
+        az += s * dz;
+    }
+};
+
+/*
+    Swirls around an axis through center, a = s (axis x (x - center))
+    The pull grows with the distance from the axis, like a rigid rotation
+*/
+struct Vortex : ForceField<Vortex>
+{
+    float cx, cy, cz;
+    float nx, ny, nz;
+    float strength;
+
+    Vortex(const glm::vec3& center, const glm::vec3& axis, float s)
+        : cx(center.x), cy(center.y), cz(center.z), strength(s)
+    {
+        glm::vec3 n = glm::normalize(axis);
+        nx = n.x;
+        ny = n.y;
+        nz = n.z;
+    }
+
+    inline void Apply(float x, float y, float z, float, float, float,
+                      float& ax, float& ay, float& az) const
+    {
+        float dx = x - cx;
+        float dy = y - cy;
+        float dz = z - cz;
+        ax += strength * (ny * dz - nz * dy);
+        ay += strength * (nz * dx - nx * dz);
+        az += strength * (nx * dy - ny * dx);
+    }
+};
+
+/*
+    Velocity damping that ignores the mass, a = -c v
+    Same form as LinearDrag, kept separate so numerical damping added for
+    stability does not get mixed up with the physical drag of a body
+*/
+struct Damping : ForceField<Damping>
+{
+    float c;
+
+    explicit Damping(float rate) : c(rate) {}
+
+    inline void Apply(float, float, float, float vx, float vy, float vz,
+                      float& ax, float& ay, float& az) const
+    {
+        ax -= c * vx;
+        ay -= c * vy;
+        az -= c * vz;
+    }
+};
+
+//  Acceleration of a single body under a set of forces
+template <class Forces>
+inline glm::vec3 Acceleration(const Forces& forces, const glm::vec3& position, const glm::vec3& velocity)
+{
+    float ax = 0.0f, ay = 0.0f, az = 0.0f;
+    forces.Apply(position.x, position.y, position.z, velocity.x, velocity.y, velocity.z, ax, ay, az);
+    return glm::vec3(ax, ay, az);
+}
+
+#endif // !FORCE_FIELD_H
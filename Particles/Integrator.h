@@ -0,0 +1,227 @@
+#pragma once
+#ifndef INTEGRATOR_H
+#define INTEGRATOR_H
+
+#include <cmath>
+#include <glm/glm.hpp>
+
+/*
+    Integrators as compile time policies
+
+    Each policy has a static Step function that advances one body with
+    position (x, y, z) and velocity (vx, vy, vz) by a timestep h under a set
+    of force fields (see ForceField.h). The policy is a template argument of
+    the update, so the chosen scheme and the forces are inlined together into
+    one loop.
+
+    Order of accuracy and force evaluations per step
+    ExplicitEuler       1st order, 1 evaluation
+    SemiImplicitEuler   1st order, 1 evaluation, symplectic so orbits and
+                        oscillations do not gain energy
+    VelocityVerlet      2nd order, 2 evaluations (1 for forces that do not
+                        depend on the velocity, the compiler drops the other)
+    RK4                 4th order, 4 evaluations
+
+    A higher order scheme is more work per step but reaches the same error
+    with far fewer steps, see RunIntegratorBenchmark in the particle sim.
+*/
+
+/*
+    x(n+1) = x(n) + v(n)h
+    v(n+1) = v(n) + a(x(n), v(n))h
+*/
+struct ExplicitEuler
+{
+    static const char* Name() { return "Explicit Euler"; }
+    static const int Order = 1;
+
+    template <class Forces>
+    static inline void Step(const Forces& forces, float h,
+                            float& x, float& y, float& z, float& vx, float& vy, float& vz)
+    {
+        float ax = 0.0f, ay = 0.0f, az = 0.0f;
+        forces.Apply(x, y, z, vx, vy, vz, ax, ay, az);
+
+        x += h * vx;
+        y += h * vy;
+        z += h * vz;
+
+        vx += h * ax;
+        vy += h * ay;
+        vz += h * az;
+    }
+};
+
+/*
+    v(n+1) = v(n) + a(x(n), v(n))h
+    x(n+1) = x(n) + v(n+1)h
+*/
+struct SemiImplicitEuler
+{
+    static const char* Name() { return "Semi-implicit Euler"; }
+    static const int Order = 1;
+
+    template <class Forces>
+    static inline void Step(const Forces& forces, float h,
+                            float& x, float& y, float& z, float& vx, float& vy, float& vz)
+    {
+        float ax = 0.0f, ay = 0.0f, az = 0.0f;
+        forces.Apply(x, y, z, vx, vy, vz, ax, ay, az);
+
+        vx += h * ax;
+        vy += h * ay;
+        vz += h * az;
+
+        x += h * vx;
+        y += h * vy;
+        z += h * vz;
+    }
+};
+
+/*
+    x(n+1) = x(n) + v(n)h + a(n)h^2/2
+    v(n+1) = v(n) + (a(n) + a(n+1))h/2
+    Velocity dependent forces are evaluated at the end of the step with the
+    predicted velocity v(n) + a(n)h
+    Exact for a constant acceleration
+*/
+struct VelocityVerlet
+{
+    static const char* Name() { return "Velocity Verlet"; }
+    static const int Order = 2;
+
+    template <class Forces>
+    static inline void Step(const Forces& forces, float h,
+                            float& x, float& y, float& z, float& vx, float& vy, float& vz)
+    {
+        const float halfH = 0.5f * h;
+
+        float ax = 0.0f, ay = 0.0f, az = 0.0f;
+        forces.Apply(x, y, z, vx, vy, vz, ax, ay, az);
+
+        vx += halfH * ax;
+        vy += halfH * ay;
+        vz += halfH * az;
+
+        x += h * vx;
+        y += h * vy;
+        z += h * vz;
+
+        float bx = 0.0f, by = 0.0f, bz = 0.0f;
+        forces.Apply(x, y, z, vx + halfH * ax, vy + halfH * ay, vz + halfH * az, bx, by, bz);
+
+        vx += halfH * bx;
+        vy += halfH * by;
+        vz += halfH * bz;
+    }
+};
+
+/*
+    Classic 4th order Runge-Kutta on the state (x, v)
+    k1 = f(s), k2 = f(s + k1 h/2), k3 = f(s + k2 h/2), k4 = f(s + k3 h)
+    s(n+1) = s(n) + (k1 + 2k2 + 2k3 + k4)h/6
+*/
+struct RK4
+{
+    static const char* Name() { return "RK4"; }
+    static const int Order = 4;
+
+    template <class Forces>
+    static inline void Step(const Forces& forces, float h,
+                            float& x, float& y, float& z, float& vx, float& vy, float& vz)
+    {
+        const float halfH = 0.5f * h;
+        const float sixthH = h / 6.0f;
+
+        //  k1, the derivative of x is the velocity itself
+        float a1x = 0.0f, a1y = 0.0f, a1z = 0.0f;
+        forces.Apply(x, y, z, vx, vy, vz, a1x, a1y, a1z);
+
+        //  k2
+        float v2x = vx + halfH * a1x, v2y = vy + halfH * a1y, v2z = vz + halfH * a1z;
+        float a2x = 0.0f, a2y = 0.0f, a2z = 0.0f;
+        forces.Apply(x + halfH * vx, y + halfH * vy, z + halfH * vz, v2x, v2y, v2z, a2x, a2y, a2z);
+
+        //  k3
+        float v3x = vx + halfH * a2x, v3y = vy + halfH * a2y, v3z = vz + halfH * a2z;
+        float a3x = 0.0f, a3y = 0.0f, a3z = 0.0f;
+        forces.Apply(x + halfH * v2x, y + halfH * v2y, z + halfH * v2z, v3x, v3y, v3z, a3x, a3y, a3z);
+
+        //  k4
+        float v4x = vx + h * a3x, v4y = vy + h * a3y, v4z = vz + h * a3z;
+        float a4x = 0.0f, a4y = 0.0f, a4z = 0.0f;
+        forces.Apply(x + h * v3x, y + h * v3y, z + h * v3z, v4x, v4y, v4z, a4x, a4y, a4z);
+
+        x += sixthH * (vx + 2.0f * (v2x + v3x) + v4x);
+        y += sixthH * (vy + 2.0f * (v2y + v3y) + v4y);
+        z += sixthH * (vz + 2.0f * (v2z + v3z) + v4z);
+
+        vx += sixthH * (a1x + 2.0f * (a2x + a3x) + a4x);
+        vy += sixthH * (a1y + 2.0f * (a2y + a3y) + a4y);
+        vz += sixthH * (a1z + 2.0f * (a2z + a3z) + a4z);
+    }
+};
+
+/*
+    Step size control for adaptive stepping by step doubling
+
+    A trial step of h is taken once as a whole and once as two halves. For a
+    method of order p the difference between the two, divided by 2^p - 1,
+    estimates the error of the halves. A step is accepted when that error is
+    within the tolerance, and either way the next trial step is scaled by
+        0.9 (tolerance / error)^(1 / (p + 1))
+    kept within [minStep, maxStep] and at most 5 times larger or smaller.
+    Steps grow while the motion is smooth and shrink where it is not.
+*/
+struct AdaptiveStep
+{
+    float tolerance;    //  largest accepted error per step, in length units
+    float minStep;
+    float maxStep;
+    float step;         //  next trial step
+    int accepted;
+    int rejected;
+
+    AdaptiveStep(float tol = 1.0e-3f, float minH = 1.0e-4f, float maxH = 0.1f) :
+        tolerance(tol), minStep(minH), maxStep(maxH), step(minH), accepted(0), rejected(0)
+    {
+    }
+
+    //  Error of step doubling for a method of the given order
+    static float DoublingError(float difference, int order)
+    {
+        return difference / (float)((1 << order) - 1);
+    }
+
+    //  Judges a trial step of h with the given error, returns true when it is accepted
+    bool Update(float h, float error, int order)
+    {
+        bool accept = error <= tolerance || h <= minStep;
+
+        //  a NaN error, from forces that diverged, shrinks the step as far as
+        //  it goes so the caller ends up with an accepted step of minStep
+        float factor = 0.2f;
+        if (error == 0.0f)
+            factor = 5.0f;
+        else if (!std::isnan(error))
+            factor = 0.9f * std::pow(tolerance / error, 1.0f / (order + 1));
+        factor = factor < 0.2f ? 0.2f : (factor > 5.0f ? 5.0f : factor);
+        step = h * factor;
+        step = step < minStep ? minStep : (step > maxStep ? maxStep : step);
+
+        if (accept)
+            accepted++;
+        else
+            rejected++;
+        return accept;
+    }
+};
+
+//  Advances a single body
+template <class Integrator, class Forces>
+inline void Integrate(const Forces& forces, float h, glm::vec3& position, glm::vec3& velocity)
+{
+    Integrator::Step(forces, h, position.x, position.y, position.z, velocity.x, velocity.y, velocity.z);
+}
+
+#endif // !INTEGRATOR_H
@@ -0,0 +1,114 @@
+/*
+    Implementation of INTEGRATOR_BENCHMARK_H
+*/
+
+#include "IntegratorBenchmark.h"
+#include "ParticleEmitter.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    const int BENCHMARK_PARTICLES = 16384;
+    const double BENCHMARK_DURATION = 2.0;      //  simulated seconds
+    const float BENCHMARK_DRAG = 0.5f;          //  linear drag coefficient, k
+    const float BENCHMARK_TIMESTEPS[] = { 0.1f, 0.05f, 0.02f, 0.01f, 0.005f, 0.001f };
+
+    const glm::vec3 BENCHMARK_GRAVITY(0.0f, -9.8f, 0.0f);
+    const glm::vec3 BENCHMARK_VELOCITY(5.0f, 10.0f, 0.0f);
+
+    //  Emitter holding the burst, the same particles for every run
+    ParticleEmitter* CreateBurst()
+    {
+        //  particles never die during the run and the emission is off
+        ParticleEmitter* emitter = new ParticleEmitter(BENCHMARK_PARTICLES, glm::vec3(0.0f), BENCHMARK_VELOCITY, 2.0f, 1.0e6f, 0.0f);
+        emitter->SetEmissionRate(0.0f);
+        emitter->SetSeed(1);
+        emitter->Burst(BENCHMARK_PARTICLES);
+        return emitter;
+    }
+
+    //  Exact position of one axis after time t
+    double ExactPosition(double x0, double v0, double g, double k, double t)
+    {
+        double terminal = g / k;
+        return x0 + terminal * t + (v0 - terminal) * (1.0 - std::exp(-k * t)) / k;
+    }
+
+    template <class Integrator>
+    void BenchmarkIntegrator()
+    {
+        const int runs = sizeof(BENCHMARK_TIMESTEPS) / sizeof(BENCHMARK_TIMESTEPS[0]);
+        const auto forces = Gravity(BENCHMARK_GRAVITY) + LinearDrag(BENCHMARK_DRAG);
+
+        for (int r = 0; r < runs; r++)
+        {
+            float h = BENCHMARK_TIMESTEPS[r];
+            int steps = (int)std::floor(BENCHMARK_DURATION / h + 0.5);
+
+            ParticleEmitter* emitter = CreateBurst();
+            emitter->SetTimestep(h);
+
+            //  starting state of every particle
+            const ParticleData& particles = emitter->GetParticles();
+            int count = emitter->GetLiveCount();
+            std::vector<float> start(particles.m_x, particles.m_x + count);
+            std::vector<float> startY(particles.m_y, particles.m_y + count);
+            std::vector<float> startZ(particles.m_z, particles.m_z + count);
+            std::vector<float> startVX(particles.m_vx, particles.m_vx + count);
+            std::vector<float> startVY(particles.m_vy, particles.m_vy + count);
+            std::vector<float> startVZ(particles.m_vz, particles.m_vz + count);
+
+            std::chrono::high_resolution_clock::time_point begin = std::chrono::high_resolution_clock::now();
+            for (int s = 0; s < steps; s++)
+                emitter->AddForce<Integrator>(forces);
+            std::chrono::high_resolution_clock::time_point end = std::chrono::high_resolution_clock::now();
+
+            //  the pool is never reordered, particle i is still particle i
+            double t = steps * (double)h;
+            double k = BENCHMARK_DRAG;
+            double maxError = 0.0;
+            for (int i = 0; i < count; i++)
+            {
+                double dx = particles.m_x[i] - ExactPosition(start[i], startVX[i], BENCHMARK_GRAVITY.x, k, t);
+                double dy = particles.m_y[i] - ExactPosition(startY[i], startVY[i], BENCHMARK_GRAVITY.y, k, t);
+                double dz = particles.m_z[i] - ExactPosition(startZ[i], startVZ[i], BENCHMARK_GRAVITY.z, k, t);
+                maxError = std::max(maxError, std::sqrt(dx * dx + dy * dy + dz * dz));
+            }
+
+            double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+            double nsPerParticleStep = ms * 1.0e6 / ((double)steps * count);
+
+            std::cout << std::left << std::setw(22) << Integrator::Name() << std::right
+                      << std::setw(8) << h
+                      << std::setw(8) << steps
+                      << std::setw(14) << std::scientific << std::setprecision(3) << maxError
+                      << std::setw(12) << std::fixed << std::setprecision(2) << ms
+                      << std::setw(12) << std::setprecision(3) << nsPerParticleStep
+                      << std::defaultfloat << std::setprecision(6) << std::endl;
+
+            delete emitter;
+        }
+    }
+}
+
+void RunIntegratorBenchmark()
+{
+    std::cout << "Integrator benchmark: " << BENCHMARK_PARTICLES << " particles, gravity and linear drag k = "
+              << BENCHMARK_DRAG << ", " << BENCHMARK_DURATION << " s simulated" << std::endl;
+    std::cout << std::left << std::setw(22) << "Integrator" << std::right
+              << std::setw(8) << "h"
+              << std::setw(8) << "steps"
+              << std::setw(14) << "max error"
+              << std::setw(12) << "time (ms)"
+              << std::setw(12) << "ns/p-step" << std::endl;
+
+    BenchmarkIntegrator<ExplicitEuler>();
+    BenchmarkIntegrator<SemiImplicitEuler>();
+    BenchmarkIntegrator<VelocityVerlet>();
+    BenchmarkIntegrator<RK4>();
+}
@@ -0,0 +1,17 @@
+#pragma once
+#ifndef INTEGRATOR_BENCHMARK_H
+#define INTEGRATOR_BENCHMARK_H
+
+/*
+    Accuracy against cost of the integrators of Integrator.h
+
+    Integrates a burst of particles under gravity and linear drag, which has
+    the closed form solution
+        v(t) = g/k + (v0 - g/k)e^(-kt)
+        x(t) = x0 + (g/k)t + (v0 - g/k)(1 - e^(-kt))/k
+    for a range of timesteps and prints, for every integrator and timestep,
+    the largest position error after the run next to the time it took.
+*/
+void RunIntegratorBenchmark();
+
+#endif // !INTEGRATOR_BENCHMARK_H
@@ -0,0 +1,82 @@
+/*
+    Implementation of MORTON_H
+*/
+
+#include "Morton.h"
+#include <algorithm>
+
+//  Keys per chunk of the radix sort, each chunk keeps its own histogram
+const int RADIX_CHUNK_SIZE = 8192;
+const int RADIX_BUCKETS = 256;
+
+void Morton::RadixSort(uint64_t* keys, int* values, int count, int keyBits, ThreadPool* pool,
+    std::vector<uint64_t>& keyScratch, std::vector<int>& valueScratch)
+{
+    if (count <= 1)
+        return;
+
+    keyScratch.resize(count);
+    valueScratch.resize(count);
+
+    int chunks = (count + RADIX_CHUNK_SIZE - 1) / RADIX_CHUNK_SIZE;
+    std::vector<int> histograms((size_t)chunks * RADIX_BUCKETS);
+
+    uint64_t* srcKeys = keys;
+    int* srcValues = values;
+    uint64_t* dstKeys = &keyScratch[0];
+    int* dstValues = &valueScratch[0];
+
+    //  Runs task over every chunk, on the pool when there is one
+    auto forEachChunk = [&](const std::function<void(int, int)>& task) {
+        if (pool != NULL)
+            pool->ParallelFor(count, RADIX_CHUNK_SIZE, task);
+        else
+            for (int begin = 0; begin < count; begin += RADIX_CHUNK_SIZE)
+                task(begin, std::min(begin + RADIX_CHUNK_SIZE, count));
+    };
+
+    for (int shift = 0; shift < keyBits; shift += 8)
+    {
+        //  1. digit histogram of every chunk
+        forEachChunk([&](int begin, int end) {
+            int* histogram = &histograms[(size_t)(begin / RADIX_CHUNK_SIZE) * RADIX_BUCKETS];
+            std::fill(histogram, histogram + RADIX_BUCKETS, 0);
+            for (int i = begin; i < end; i++)
+                histogram[(srcKeys[i] >> shift) & 0xFF]++;
+        });
+
+        //  2. turn the histograms into scatter offsets: digit major, chunk minor
+        int offset = 0;
+        for (int digit = 0; digit < RADIX_BUCKETS; digit++)
+        {
+            for (int chunk = 0; chunk < chunks; chunk++)
+            {
+                int& slot = histograms[(size_t)chunk * RADIX_BUCKETS + digit];
+                int size = slot;
+                slot = offset;
+                offset += size;
+            }
+        }
+
+        //  3. scatter, every chunk writes to its own slots
+        forEachChunk([&](int begin, int end) {
+            int* cursor = &histograms[(size_t)(begin / RADIX_CHUNK_SIZE) * RADIX_BUCKETS];
+            for (int i = begin; i < end; i++)
+            {
+                int dst = cursor[(srcKeys[i] >> shift) & 0xFF]++;
+                dstKeys[dst] = srcKeys[i];
+                dstValues[dst] = srcValues[i];
+            }
+        });
+
+        std::swap(srcKeys, dstKeys);
+        std::swap(srcValues, dstValues);
+    }
+
+    //  an odd number of passes leaves the result in the scratch buffers
+    if (srcKeys != keys)
+    {
+        std::copy(srcKeys, srcKeys + count, keys);
+        std::copy(srcValues, srcValues + count, values);
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#ifndef MORTON_H
+#define MORTON_H
+
+#include "ThreadPool.h"
+#include <stdint.h>
+#include <vector>
+
+/*
+    Morton (Z-order) codes and the radix sort used to order particles by them
+    Points close in space get close codes, so sorting by code puts
+    neighbouring particles next to each other in memory.
+*/
+namespace Morton
+{
+    //  Spreads the low 10 bits of v so there are two zero bits between each
+    inline uint32_t Spread10(uint32_t v)
+    {
+        v &= 0x3FFu;
+        v = (v | (v << 16)) & 0x030000FFu;
+        v = (v | (v << 8)) & 0x0300F00Fu;
+        v = (v | (v << 4)) & 0x030C30C3u;
+        v = (v | (v << 2)) & 0x09249249u;
+        return v;
+    }
+
+    //  Spreads the low 21 bits of v so there are two zero bits between each
+    inline uint64_t Spread21(uint64_t v)
+    {
+        v &= 0x1FFFFFull;
+        v = (v | (v << 32)) & 0x001F00000000FFFFull;
+        v = (v | (v << 16)) & 0x001F0000FF0000FFull;
+        v = (v | (v << 8)) & 0x100F00F00F00F00Full;
+        v = (v | (v << 4)) & 0x10C30C30C30C30C3ull;
+        v = (v | (v << 2)) & 0x1249249249249249ull;
+        return v;
+    }
+
+    //  30-bit code of a cell, x, y and z in [0, 1024)
+    inline uint32_t Encode30(uint32_t x, uint32_t y, uint32_t z)
+    {
+        return Spread10(x) | (Spread10(y) << 1) | (Spread10(z) << 2);
+    }
+
+    //  63-bit code of a cell, x, y and z in [0, 2097152)
+    inline uint64_t Encode63(uint64_t x, uint64_t y, uint64_t z)
+    {
+        return Spread21(x) | (Spread21(y) << 1) | (Spread21(z) << 2);
+    }
+
+    /*
+        Stable LSD radix sort of keys[0, count) carrying values along, 8 bits per pass
+        keyBits limits the passes to the bits actually used by the keys
+        Every pass builds one histogram per chunk, so chunks can be counted
+        and scattered in parallel while keeping the sort stable.
+        keys and values are sorted in place, the scratch vectors are reused
+    */
+    void RadixSort(uint64_t* keys, int* values, int count, int keyBits, ThreadPool* pool,
+        std::vector<uint64_t>& keyScratch, std::vector<int>& valueScratch);
+}
+
+#endif // !MORTON_H
@@ -12,7 +12,7 @@ Particle::~Particle()
 {
 }
 
-bool Particle::IsAlive() 
+bool Particle::IsAlive() const
 {
     if (m_life <= 0.0f)
         return false;
@@ -11,7 +11,7 @@ public:
     Particle();
     ~Particle();
 
-    bool IsAlive();
+    bool IsAlive() const;
 
 private:
     glm::vec3 m_position;       //  position
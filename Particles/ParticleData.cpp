@@ -0,0 +1,149 @@
+/*
+    Implementation of PARTICLE_DATA_H
+*/
+
+#include "ParticleData.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+static void* AlignedAlloc(size_t bytes)
+{
+    //  round up so the allocation size is a multiple of the alignment
+    bytes = (bytes + PARTICLE_ALIGNMENT - 1) / PARTICLE_ALIGNMENT * PARTICLE_ALIGNMENT;
+    if (bytes == 0)
+        bytes = PARTICLE_ALIGNMENT;
+#ifdef _MSC_VER
+    void* ptr = _aligned_malloc(bytes, PARTICLE_ALIGNMENT);
+#else
+    void* ptr = aligned_alloc(PARTICLE_ALIGNMENT, bytes);
+#endif
+    if (ptr == NULL)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+static void AlignedFree(void* ptr)
+{
+#ifdef _MSC_VER
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+ParticleData::ParticleData() :
+    m_x(NULL), m_y(NULL), m_z(NULL), m_vx(NULL), m_vy(NULL), m_vz(NULL), m_life(NULL), m_pid(NULL), m_count(0), m_owner(false)
+{
+}
+
+ParticleData::~ParticleData()
+{
+    Release();
+}
+
+void ParticleData::Allocate(int count)
+{
+    Release();
+
+    size_t floatBytes = count * sizeof(float);
+    m_x = (float*)AlignedAlloc(floatBytes);
+    m_y = (float*)AlignedAlloc(floatBytes);
+    m_z = (float*)AlignedAlloc(floatBytes);
+    m_vx = (float*)AlignedAlloc(floatBytes);
+    m_vy = (float*)AlignedAlloc(floatBytes);
+    m_vz = (float*)AlignedAlloc(floatBytes);
+    m_life = (float*)AlignedAlloc(floatBytes);
+    m_pid = (int*)AlignedAlloc(count * sizeof(int));
+    m_count = count;
+    m_owner = true;
+}
+
+/*
+    Points at particles [offset, offset + count) of arena without owning them
+    The arena must outlive the view
+*/
+void ParticleData::View(ParticleData& arena, int offset, int count)
+{
+    Release();
+
+    m_x = arena.m_x + offset;
+    m_y = arena.m_y + offset;
+    m_z = arena.m_z + offset;
+    m_vx = arena.m_vx + offset;
+    m_vy = arena.m_vy + offset;
+    m_vz = arena.m_vz + offset;
+    m_life = arena.m_life + offset;
+    m_pid = arena.m_pid + offset;
+    m_count = count;
+    m_owner = false;
+}
+
+void ParticleData::Release()
+{
+    if (m_owner)
+    {
+        AlignedFree(m_x);
+        AlignedFree(m_y);
+        AlignedFree(m_z);
+        AlignedFree(m_vx);
+        AlignedFree(m_vy);
+        AlignedFree(m_vz);
+        AlignedFree(m_life);
+        AlignedFree(m_pid);
+    }
+
+    m_x = m_y = m_z = NULL;
+    m_vx = m_vy = m_vz = NULL;
+    m_life = NULL;
+    m_pid = NULL;
+    m_count = 0;
+    m_owner = false;
+}
+
+/*
+    Exchanges the arrays of two buffers without copying
+*/
+void ParticleData::Swap(ParticleData& other)
+{
+    std::swap(m_x, other.m_x);
+    std::swap(m_y, other.m_y);
+    std::swap(m_z, other.m_z);
+    std::swap(m_vx, other.m_vx);
+    std::swap(m_vy, other.m_vy);
+    std::swap(m_vz, other.m_vz);
+    std::swap(m_life, other.m_life);
+    std::swap(m_pid, other.m_pid);
+    std::swap(m_count, other.m_count);
+    std::swap(m_owner, other.m_owner);
+}
+
+/*
+    Copies the first count particles of other
+*/
+void ParticleData::CopyFrom(const ParticleData& other, int count)
+{
+    memcpy(m_x, other.m_x, count * sizeof(float));
+    memcpy(m_y, other.m_y, count * sizeof(float));
+    memcpy(m_z, other.m_z, count * sizeof(float));
+    memcpy(m_vx, other.m_vx, count * sizeof(float));
+    memcpy(m_vy, other.m_vy, count * sizeof(float));
+    memcpy(m_vz, other.m_vz, count * sizeof(float));
+    memcpy(m_life, other.m_life, count * sizeof(float));
+    memcpy(m_pid, other.m_pid, count * sizeof(int));
+}
+
+int ParticleData::Count() const
+{
+    return m_count;
+}
+
+bool ParticleData::IsView() const
+{
+    return m_count > 0 && !m_owner;
+}
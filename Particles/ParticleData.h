@@ -0,0 +1,53 @@
+#pragma once
+#ifndef PARTICLE_DATA_H
+#define PARTICLE_DATA_H
+
+//  Alignment of every attribute array, one cache line
+const int PARTICLE_ALIGNMENT = 64;
+
+//  Views into an arena start at multiples of this many particles to stay aligned
+const int PARTICLE_VIEW_GRANULARITY = PARTICLE_ALIGNMENT / sizeof(float);
+
+/*
+    Structure-of-arrays particle storage
+    Every attribute lives in its own cache line aligned array so the update
+    kernels only stream the fields they actually touch
+    A buffer either owns its arrays (Allocate) or views a slice of another
+    buffer's arrays (View), which is how emitters share one arena
+*/
+class ParticleData
+{
+public:
+    ParticleData();
+    ~ParticleData();
+
+    void Allocate(int count);
+    void View(ParticleData& arena, int offset, int count);
+    void Release();
+    void Swap(ParticleData& other);
+    void CopyFrom(const ParticleData& other, int count);
+    int Count() const;
+    bool IsView() const;
+
+    //  hot attributes, touched every step
+    float* m_x;
+    float* m_y;
+    float* m_z;
+    float* m_vx;
+    float* m_vy;
+    float* m_vz;
+    float* m_life;
+
+    //  cold attributes
+    int* m_pid;
+
+private:
+    int m_count;
+    bool m_owner;
+
+    //  non-copyable, owns its arrays
+    ParticleData(const ParticleData&);
+    ParticleData& operator=(const ParticleData&);
+};
+
+#endif // !PARTICLE_DATA_H
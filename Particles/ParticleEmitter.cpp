@@ -3,83 +3,511 @@
 */
 
 #include "ParticleEmitter.h"
+#include "Random.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 
 ParticleEmitter::ParticleEmitter(int maxCount, glm::vec3 pos, glm::vec3 vel, float velVariance, float life, float lifeVariance) :
-    m_maxCount(maxCount), m_position(pos), m_velocity(vel), m_velocityVariance(velVariance), m_life(life), m_lifeVariance(lifeVariance)
+    m_maxCount(maxCount), m_position(pos), m_velocity(vel), m_velocityVariance(velVariance), m_life(life), m_lifeVariance(lifeVariance),
+    m_emissionRate(0.0f), m_emissionDebt(0.0f), m_timestep(0.01f), m_liveCount(0), m_spawnCount(0), m_seed(0), m_stream(0), m_idBase(0), m_idMask(0xFFFFFFFFu), m_radius(0.0f),
+    m_colliders(NULL), m_restitution(0.5f), m_friction(0.1f), m_reorderInterval(0), m_mortonBits(30), m_stepCount(0), m_lastReorderTime(0.0), m_pool(NULL)
 {
-    m_particles = new Particle[m_maxCount];
+    m_particles.Allocate(m_maxCount);
+    Initialize();
+}
+
+ParticleEmitter::ParticleEmitter(ParticleData& arena, int offset, int maxCount, glm::vec3 pos, glm::vec3 vel, float velVariance, float life, float lifeVariance) :
+    m_maxCount(maxCount), m_position(pos), m_velocity(vel), m_velocityVariance(velVariance), m_life(life), m_lifeVariance(lifeVariance),
+    m_emissionRate(0.0f), m_emissionDebt(0.0f), m_timestep(0.01f), m_liveCount(0), m_spawnCount(0), m_seed(0), m_stream(0), m_idBase(0), m_idMask(0xFFFFFFFFu), m_radius(0.0f),
+    m_colliders(NULL), m_restitution(0.5f), m_friction(0.1f), m_reorderInterval(0), m_mortonBits(30), m_stepCount(0), m_lastReorderTime(0.0), m_pool(NULL)
+{
+    m_particles.View(arena, offset, m_maxCount);
     Initialize();
 }
 
 ParticleEmitter::~ParticleEmitter()
 {
-    delete[] m_particles;
 }
 
+/*
+    Starts with no live particles and picks the emission rate that fills
+    the pool exactly when the first particles die
+*/
 void ParticleEmitter::Initialize() 
 {
-    for (int i = 0; i < m_maxCount; i++)
+    m_liveCount = 0;
+    m_emissionDebt = 0.0f;
+    m_emissionRate = m_life > 0.0f ? m_maxCount / m_life : 0.0f;
+}
+
+void ParticleEmitter::SetThreadPool(ThreadPool* pool)
+{
+    m_pool = pool;
+}
+
+void ParticleEmitter::SetTimestep(float h)
+{
+    if (h > 0.0f)
+        m_timestep = h;
+}
+
+float ParticleEmitter::GetTimestep() const
+{
+    return m_timestep;
+}
+
+void ParticleEmitter::SetPosition(const glm::vec3& pos)
+{
+    m_position = pos;
+}
+
+void ParticleEmitter::SetVelocity(const glm::vec3& vel)
+{
+    m_velocity = vel;
+}
+
+void ParticleEmitter::SetLife(float life)
+{
+    m_life = life;
+}
+
+glm::vec3 ParticleEmitter::GetPosition() const
+{
+    return m_position;
+}
+
+glm::vec3 ParticleEmitter::GetVelocity() const
+{
+    return m_velocity;
+}
+
+float ParticleEmitter::GetLife() const
+{
+    return m_life;
+}
+
+/*
+    Integrates every live particle under a constant acceleration
+*/
+void ParticleEmitter::AddForce(const glm::vec3& gravity)
+{
+    AddForce(Gravity(gravity));
+}
+
+/*
+    Everything after the integration: removes dead particles, reorders,
+    resolves collisions and emits new particles
+    Serial so the packing order does not depend on the thread count
+*/
+void ParticleEmitter::FinishStep(float h)
+{
+    KillDead();
+
+    m_stepCount++;
+    if (m_reorderInterval > 0 && m_stepCount % m_reorderInterval == 0)
+        Reorder();
+
+    if (m_colliders != NULL)
+        CollideWithColliders();
+
+    if (m_radius > 0.0f)
+        Collide();
+
+    Emit(h);
+}
+
+void ParticleEmitter::SetCollisionRadius(float radius)
+{
+    m_radius = radius > 0.0f ? radius : 0.0f;
+    if (m_radius > 0.0f)
+        m_grid.SetCellSize(2.0f * m_radius);
+}
+
+void ParticleEmitter::SetColliders(const ColliderSet* colliders, float restitution, float friction)
+{
+    m_colliders = colliders;
+    m_restitution = restitution;
+    m_friction = friction;
+}
+
+void ParticleEmitter::SetReorderInterval(int interval, int bits)
+{
+    m_reorderInterval = interval > 0 ? interval : 0;
+    m_mortonBits = bits > 30 ? 63 : 30;
+}
+
+double ParticleEmitter::GetLastReorderTime() const
+{
+    return m_lastReorderTime;
+}
+
+/*
+    Sorts the live particles by the Morton code of their position
+    The codes are computed on the bounding box of the live particles,
+    radix sorted together with the particle indices, and every attribute
+    array is gathered into a scratch buffer that then takes the place of
+    the current one
+*/
+void ParticleEmitter::Reorder()
+{
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    int count = m_liveCount;
+    if (count > 1)
     {
-        m_particles[i].m_position = m_position;
-        m_particles[i].m_velocity = m_velocity;
-        m_particles[i].m_life = m_life;
-        m_particles[i].m_alive = true;
-        m_particles[i].m_pid = i;
+        //  Bounding box of the live particles
+        glm::vec3 lower(m_particles.m_x[0], m_particles.m_y[0], m_particles.m_z[0]);
+        glm::vec3 upper = lower;
+        for (int i = 1; i < count; i++)
+        {
+            lower.x = std::min(lower.x, m_particles.m_x[i]);
+            lower.y = std::min(lower.y, m_particles.m_y[i]);
+            lower.z = std::min(lower.z, m_particles.m_z[i]);
+            upper.x = std::max(upper.x, m_particles.m_x[i]);
+            upper.y = std::max(upper.y, m_particles.m_y[i]);
+            upper.z = std::max(upper.z, m_particles.m_z[i]);
+        }
+
+        //  Quantize to the cells of the code, same scale on every axis
+        float cells = m_mortonBits == 63 ? 2097151.0f : 1023.0f;
+        float extent = std::max(upper.x - lower.x, std::max(upper.y - lower.y, upper.z - lower.z));
+        float scale = extent > 0.0f ? cells / extent : 0.0f;
+
+        m_mortonKeys.resize(count);
+        m_order.resize(count);
+
+        auto encode = [&](int begin, int end) {
+            for (int i = begin; i < end; i++)
+            {
+                uint32_t cx = (uint32_t)((m_particles.m_x[i] - lower.x) * scale);
+                uint32_t cy = (uint32_t)((m_particles.m_y[i] - lower.y) * scale);
+                uint32_t cz = (uint32_t)((m_particles.m_z[i] - lower.z) * scale);
+                m_mortonKeys[i] = m_mortonBits == 63 ? Morton::Encode63(cx, cy, cz) : Morton::Encode30(cx, cy, cz);
+                m_order[i] = i;
+            }
+        };
+        if (m_pool == NULL)
+            encode(0, count);
+        else
+            m_pool->ParallelFor(count, PARTICLE_CHUNK_SIZE, encode);
+
+        Morton::RadixSort(&m_mortonKeys[0], &m_order[0], count, m_mortonBits, m_pool, m_keyScratch, m_orderScratch);
+
+        //  Gather every attribute in the new order
+        if (m_reorderScratch.Count() != m_maxCount)
+            m_reorderScratch.Allocate(m_maxCount);
+
+        auto gather = [&](int begin, int end) {
+            for (int i = begin; i < end; i++)
+            {
+                int src = m_order[i];
+                m_reorderScratch.m_x[i] = m_particles.m_x[src];
+                m_reorderScratch.m_y[i] = m_particles.m_y[src];
+                m_reorderScratch.m_z[i] = m_particles.m_z[src];
+                m_reorderScratch.m_vx[i] = m_particles.m_vx[src];
+                m_reorderScratch.m_vy[i] = m_particles.m_vy[src];
+                m_reorderScratch.m_vz[i] = m_particles.m_vz[src];
+                m_reorderScratch.m_life[i] = m_particles.m_life[src];
+                m_reorderScratch.m_pid[i] = m_particles.m_pid[src];
+            }
+        };
+        if (m_pool == NULL)
+            gather(0, count);
+        else
+            m_pool->ParallelFor(count, PARTICLE_CHUNK_SIZE, gather);
+
+        //  an arena view cannot hand its arrays over, copy back instead
+        if (m_particles.IsView())
+            m_particles.CopyFrom(m_reorderScratch, count);
+        else
+            m_particles.Swap(m_reorderScratch);
     }
+
+    std::chrono::high_resolution_clock::time_point stop = std::chrono::high_resolution_clock::now();
+    m_lastReorderTime = std::chrono::duration<double, std::milli>(stop - start).count();
 }
 
-void ParticleEmitter::AddForce(const glm::vec3& gravity)
+/*
+    Bounces the live particles off the static colliders
+    Each chunk is tested and resolved with the batch kernel of ColliderSet
+    and only touches its own particles
+*/
+void ParticleEmitter::CollideWithColliders()
 {
-    //  timestep, h=0.01;
-    float h = 0.01f;
+    PROFILE_SCOPE("ParticleEmitter::CollideWithColliders");
+    auto resolve = [this](int begin, int end) {
+        ParticleData& p = m_particles;
+        m_colliders->Resolve(p.m_x + begin, p.m_y + begin, p.m_z + begin, p.m_vx + begin, p.m_vy + begin, p.m_vz + begin,
+                             end - begin, m_radius, m_restitution, m_friction);
+    };
 
-    //  Update position and velocity of each particle in the m_particles array
-    //  Decrease life by 0.01;
-    //  if life <= 0.0, set m_alive to false
-    //  push index onto stack
-    for (int i = 0; i < m_maxCount; i++)
+    if (m_pool == NULL)
+        resolve(0, m_liveCount);
+    else
+        m_pool->ParallelFor(m_liveCount, PARTICLE_CHUNK_SIZE, resolve);
+}
+
+/*
+    Resolves elastic collisions between live particles
+    Every particle computes its new velocity from the velocities before the
+    pass, so the particles can be processed in any order and in parallel
+*/
+void ParticleEmitter::Collide()
+{
+    PROFILE_SCOPE("ParticleEmitter::Collide");
+    m_grid.Build(m_particles.m_x, m_particles.m_y, m_particles.m_z, m_liveCount, m_pool);
+    m_collisionVelocity.resize(3 * (size_t)m_maxCount);
+
+    if (m_pool == NULL)
+        CollideRange(0, m_liveCount);
+    else
+        m_pool->ParallelFor(m_liveCount, PARTICLE_CHUNK_SIZE, [this](int begin, int end) {
+            CollideRange(begin, end);
+        });
+
+    //  write back once every particle has seen the old velocities
+    const float* newVelocity = m_liveCount > 0 ? &m_collisionVelocity[0] : NULL;
+    for (int i = 0; i < m_liveCount; i++)
     {
-        glm::vec3 pos = m_particles[i].m_position;
-        glm::vec3 vel = m_particles[i].m_velocity;
+        m_particles.m_vx[i] = newVelocity[3 * i + 0];
+        m_particles.m_vy[i] = newVelocity[3 * i + 1];
+        m_particles.m_vz[i] = newVelocity[3 * i + 2];
+    }
+}
+
+/*
+    New velocities of particles [begin, end) after colliding with their neighbours
+    Equal masses: each approaching pair exchanges the velocity component
+    along the line between their centres
+    A particle touching several others at once takes the average of the
+    exchanges; summing them overshoots in dense clusters and blows up
+*/
+void ParticleEmitter::CollideRange(int begin, int end)
+{
+    const float* x = m_particles.m_x;
+    const float* y = m_particles.m_y;
+    const float* z = m_particles.m_z;
+    const float* vx = m_particles.m_vx;
+    const float* vy = m_particles.m_vy;
+    const float* vz = m_particles.m_vz;
+    const float contact = 4.0f * m_radius * m_radius;     //  (2r)^2
+
+    for (int i = begin; i < end; i++)
+    {
+        glm::vec3 dv(0.0f, 0.0f, 0.0f);
+        int contacts = 0;
+
+        m_grid.ForEachNeighbor(x[i], y[i], z[i], [&](int j) {
+            if (j == i)
+                return;
+
+            glm::vec3 d(x[j] - x[i], y[j] - y[i], z[j] - z[i]);
+            float distance2 = glm::dot(d, d);
+            if (distance2 >= contact || distance2 <= 0.0f)
+                return;
+
+            glm::vec3 n = d / std::sqrt(distance2);
+            glm::vec3 relative(vx[j] - vx[i], vy[j] - vy[i], vz[j] - vz[i]);
+            float approach = glm::dot(relative, n);
+
+            //  only pairs moving towards each other
+            if (approach < 0.0f)
+            {
+                dv += approach * n;
+                contacts++;
+            }
+        });
+
+        if (contacts > 1)
+            dv = dv / (float)contacts;
+
+        m_collisionVelocity[3 * i + 0] = vx[i] + dv.x;
+        m_collisionVelocity[3 * i + 1] = vy[i] + dv.y;
+        m_collisionVelocity[3 * i + 2] = vz[i] + dv.z;
+    }
+}
+
+void ParticleEmitter::SetEmissionRate(float rate)
+{
+    m_emissionRate = rate > 0.0f ? rate : 0.0f;
+}
 
-        glm::vec3 acceleration = gravity;
+float ParticleEmitter::GetEmissionRate() const
+{
+    return m_emissionRate;
+}
 
-        glm::vec3 newVel = vel + acceleration*h;
-        glm::vec3 newPos = pos + h*((newVel - vel) / 2.0f);
+/*
+    Spawns count particles right away on top of the continuous emission
+*/
+int ParticleEmitter::Burst(int count)
+{
+    return Spawn(count);
+}
 
-        m_particles[i].m_position = newPos;
-        m_particles[i].m_velocity = newVel;
+/*
+    Spawns the particles the emission rate owes for a step of h seconds
+*/
+void ParticleEmitter::Emit(float h)
+{
+    m_emissionDebt += m_emissionRate * h;
 
-        //  Reduce life
-        m_particles[i].m_life -= 1.0f;
+    int count = (int)m_emissionDebt;
+    Spawn(count);
+
+    //  a full pool drops what it cannot hold instead of saving it up
+    m_emissionDebt -= (float)count;
+}
 
-        if (m_particles[i].m_life <= 0.0f) 
+/*
+    Removes every particle whose life ran out, returns how many were removed
+*/
+int ParticleEmitter::KillDead()
+{
+    const float* life = m_particles.m_life;
+    int killed = 0;
+    int i = 0;
+    while (i < m_liveCount)
+    {
+        //  if life <= 0.0, the particle is dead; the slot is refilled
+        //  with the last live particle, which is checked next
+        if (life[i] <= 0.0f)
         {
-            m_particles[i].m_alive = false;
-            RestartDead(i);
+            Kill(i);
+            killed++;
         }
+        else
+            i++;
     }
+    return killed;
 }
 
-void ParticleEmitter::RestartDead(int i)
+/*
+    Appends up to count new particles at the emitter, returns how many were spawned
+    The variance samples of the whole batch are drawn in one go, keyed on the
+    spawn serial number of each particle
+*/
+int ParticleEmitter::Spawn(int count)
 {
-    m_particles[i].m_position = m_position;
-    m_particles[i].m_velocity = m_velocity;
-    m_particles[i].m_life = m_life;
-    m_particles[i].m_alive = true;
-    m_particles[i].m_pid = i;
+    if (count > m_maxCount - m_liveCount)
+        count = m_maxCount - m_liveCount;
+    if (count <= 0)
+        return 0;
+
+    m_variance.resize(4 * (size_t)count);
+    Random::SignedBatch(m_seed, m_stream, m_spawnCount, count, &m_variance[0]);
+
+    for (int k = 0; k < count; k++)
+        ResetParticle(m_liveCount + k, m_spawnCount + k, &m_variance[4 * k]);
+
+    m_liveCount += count;
+    m_spawnCount += count;
+    return count;
+}
+
+/*
+    Removes live particle i by moving the last live particle into its slot
+*/
+void ParticleEmitter::Kill(int i)
+{
+    int last = m_liveCount - 1;
+    if (i != last)
+    {
+        m_particles.m_x[i] = m_particles.m_x[last];
+        m_particles.m_y[i] = m_particles.m_y[last];
+        m_particles.m_z[i] = m_particles.m_z[last];
+        m_particles.m_vx[i] = m_particles.m_vx[last];
+        m_particles.m_vy[i] = m_particles.m_vy[last];
+        m_particles.m_vz[i] = m_particles.m_vz[last];
+        m_particles.m_life[i] = m_particles.m_life[last];
+        m_particles.m_pid[i] = m_particles.m_pid[last];
+    }
+    m_liveCount--;
+}
+
+/*
+    Starts a new particle in slot i
+    random holds four samples in [-1, 1): three for the velocity, one for the life
+*/
+void ParticleEmitter::ResetParticle(int i, unsigned long long serial, const float* random)
+{
+    m_particles.m_x[i] = m_position.x;
+    m_particles.m_y[i] = m_position.y;
+    m_particles.m_z[i] = m_position.z;
+    m_particles.m_vx[i] = m_velocity.x + m_velocityVariance * random[0];
+    m_particles.m_vy[i] = m_velocity.y + m_velocityVariance * random[1];
+    m_particles.m_vz[i] = m_velocity.z + m_velocityVariance * random[2];
+    m_particles.m_life[i] = m_life + m_lifeVariance * random[3];
+    m_particles.m_pid[i] = (int)(m_idBase | ((unsigned int)serial & m_idMask));
+}
+
+/*
+    Seeds the variance samples, the same seed reproduces the same particles
+*/
+void ParticleEmitter::SetSeed(unsigned int seed)
+{
+    m_seed = seed;
+}
+
+/*
+    Second half of the Philox key, so many emitters can share one seed
+*/
+void ParticleEmitter::SetStream(unsigned int stream)
+{
+    m_stream = stream;
+}
+
+/*
+    Lets the emitters of a system hand out ids that do not collide: the
+    serial wraps within its own bits instead of running into the next base
+*/
+void ParticleEmitter::SetIdBase(unsigned int base, int serialBits)
+{
+    m_idBase = base;
+    m_idMask = serialBits >= 32 ? 0xFFFFFFFFu : (1u << serialBits) - 1u;
+}
+
+int ParticleEmitter::GetMaxCount() const
+{
+    return m_maxCount;
+}
+
+int ParticleEmitter::GetLiveCount() const
+{
+    return m_liveCount;
+}
+
+const ParticleData& ParticleEmitter::GetParticles() const
+{
+    return m_particles;
+}
+
+/*
+    Gathers the attributes of particle i into a single Particle
+*/
+Particle ParticleEmitter::GetParticle(int i) const
+{
+    Particle p;
+    p.m_position = glm::vec3(m_particles.m_x[i], m_particles.m_y[i], m_particles.m_z[i]);
+    p.m_velocity = glm::vec3(m_particles.m_vx[i], m_particles.m_vy[i], m_particles.m_vz[i]);
+    p.m_pid = m_particles.m_pid[i];
+    p.m_mass = 1.0f;
+    p.m_life = m_particles.m_life[i];
+    p.m_alive = p.IsAlive();
+    return p;
 }
 
 void ParticleEmitter::PrintDetails()
 {
-    for (int i = 0; i < m_maxCount; i++)
+    for (int i = 0; i < m_liveCount; i++)
     {
-        std::cout << "Particle ID: " << m_particles[i].m_pid<<std::endl;
-        std::cout << "Position: " << m_particles[i].m_position.x <<" "<< m_particles[i].m_position.y<<" "<< m_particles[i].m_position.z << std::endl;
-        std::cout << "Velocity: " << m_particles[i].m_velocity.x<<" "<< m_particles[i].m_velocity.y << " " << m_particles[i].m_velocity.z << std::endl;
-        std::cout << "Life: " << m_particles[i].m_life << std::endl;
-        std::cout << "Alive? " << m_particles[i].m_alive << std::endl;
+        std::cout << "Particle ID: " << m_particles.m_pid[i]<<std::endl;
+        std::cout << "Position: " << m_particles.m_x[i] <<" "<< m_particles.m_y[i]<<" "<< m_particles.m_z[i] << std::endl;
+        std::cout << "Velocity: " << m_particles.m_vx[i]<<" "<< m_particles.m_vy[i] << " " << m_particles.m_vz[i] << std::endl;
+        std::cout << "Life: " << m_particles.m_life[i] << std::endl;
+        std::cout << "Alive? " << (m_particles.m_life[i] > 0.0f) << std::endl;
         std::cout << "--------------------------------" << std::endl;
     }
-}
\ No newline at end of file
+}
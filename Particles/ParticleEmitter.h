@@ -3,16 +3,98 @@
 #define PARTICLE_EMITTER_H
 
 #include "Particle.h"
+#include "ColliderSet.h"
+#include "ForceField.h"
+#include "Integrator.h"
+#include "Morton.h"
+#include "ParticleData.h"
+#include "Profiler.h"
+#include "SpatialHash.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
+//  Particles per work chunk, 7 hot float arrays * 2048 = 56KB per chunk
+const int PARTICLE_CHUNK_SIZE = 2048;
+
+/*
+    Emits and simulates up to maxCount particles
+
+    Particles are emitted continuously at a fixed rate, which by default
+    keeps maxCount particles alive once the first ones start dying, so the
+    spawn cost is spread evenly over the steps.
+
+    Live particles are kept densely packed in [0, GetLiveCount()): a new
+    particle is appended after the last live one and a dead particle is
+    replaced by the last live one, so spawning and killing are constant time
+    and the update only ever walks live particles.
+*/
 class ParticleEmitter
 {
 public:
     ParticleEmitter(int maxCount, glm::vec3 pos, glm::vec3 vel, float velVariance, float life, float lifeVariance);
+    //  Uses particles [offset, offset + maxCount) of a shared arena as its storage
+    ParticleEmitter(ParticleData& arena, int offset, int maxCount, glm::vec3 pos, glm::vec3 vel, float velVariance, float life, float lifeVariance);
     ~ParticleEmitter();
     void AddForce(const glm::vec3& gravity);
+    //  One step under any composition of force fields, see ForceField.h,
+    //  integrated with one of the policies of Integrator.h
+    template <class Integrator = VelocityVerlet, class Forces>
+    void AddForce(const Forces& forces);
+
+    //  One step of a size chosen by adaptive, see AdaptiveStep in Integrator.h,
+    //  returns the simulated time it advanced
+    template <class Integrator = VelocityVerlet, class Forces>
+    float AddForceAdaptive(const Forces& forces, AdaptiveStep& adaptive);
     void PrintDetails();
 
+    //  parallel update, NULL runs serially on the calling thread
+    void SetThreadPool(ThreadPool* pool);
+
+    //  Simulated time advanced by each AddForce, in seconds
+    void SetTimestep(float h);
+    float GetTimestep() const;
+
+    //  Emitter parameters
+    void SetPosition(const glm::vec3& pos);
+    void SetVelocity(const glm::vec3& vel);
+    void SetLife(float life);
+    glm::vec3 GetPosition() const;
+    glm::vec3 GetVelocity() const;
+    float GetLife() const;
+
+    //  Emission, in particles per second of simulated time
+    void SetEmissionRate(float rate);
+    float GetEmissionRate() const;
+    int Burst(int count);
+    void SetSeed(unsigned int seed);
+    //  Emitters sharing a seed draw independent samples when their streams differ
+    void SetStream(unsigned int stream);
+    //  Particle ids are base | (spawn serial & low serialBits), the serial alone by default
+    void SetIdBase(unsigned int base, int serialBits);
+
+    //  Elastic collisions between particles of the given radius, 0 disables them
+    void SetCollisionRadius(float radius);
+
+    //  Static planes the particles bounce off, not owned, NULL disables them
+    //  Particles collide as spheres of the collision radius, as points when it is 0
+    void SetColliders(const ColliderSet* colliders, float restitution = 0.5f, float friction = 0.1f);
+
+    //  Sorts the particles along a Morton curve every interval steps, 0 disables it
+    //  bits is 30 or 63, the finer code is only needed for very large domains
+    void SetReorderInterval(int interval, int bits = 30);
+    double GetLastReorderTime() const;
+
+    //  Pool management
+    int Spawn(int count);
+    void Kill(int i);
+
+    int GetMaxCount() const;
+    int GetLiveCount() const;
+    Particle GetParticle(int i) const;
+    const ParticleData& GetParticles() const;
+
 private:
     //  member variables
     int m_maxCount;
@@ -21,14 +103,220 @@ private:
     float m_velocityVariance;
     float m_life;
     float m_lifeVariance;
+    float m_emissionRate;
+    float m_emissionDebt;       //  particles owed to the rate, fractional
+    float m_timestep;
+
+    //  Particle attributes, stored as structure of arrays
+    ParticleData m_particles;
+    int m_liveCount;
+    unsigned long long m_spawnCount;    //  spawn serial number of the next particle
+
+    //  velocity and life variance samples of the current spawn batch
+    unsigned int m_seed;
+    unsigned int m_stream;
+    unsigned int m_idBase;
+    unsigned int m_idMask;
+    std::vector<float> m_variance;
+
+    //  particle-particle collisions
+    float m_radius;
+    SpatialHash m_grid;
+    std::vector<float> m_collisionVelocity;
+
+    //  static colliders
+    const ColliderSet* m_colliders;
+    float m_restitution;
+    float m_friction;
+
+    //  Morton reordering
+    int m_reorderInterval;
+    int m_mortonBits;
+    int m_stepCount;
+    double m_lastReorderTime;               //  milliseconds
+    ParticleData m_reorderScratch;
+    std::vector<uint64_t> m_mortonKeys;
+    std::vector<int> m_order;
+    std::vector<uint64_t> m_keyScratch;
+    std::vector<int> m_orderScratch;
 
-    //  Particle array
-    Particle* m_particles;
+    //  largest step doubling error of every chunk, for the adaptive step
+    std::vector<float> m_chunkError;
+
+    //  workers for the update, not owned
+    ThreadPool* m_pool;
 
     //  member functions
     void Initialize();
-    void RestartDead(int i);
+    void ResetParticle(int i, unsigned long long serial, const float* random);
+    template <class Integrator, class Forces>
+    void UpdateRange(int begin, int end, const Forces& forces, float h);
+    template <class Integrator, class Forces>
+    float EstimateError(const Forces& forces, float h);
+    template <class Integrator, class Forces>
+    float RangeError(int begin, int end, const Forces& forces, float h) const;
+    int KillDead();
+    void Emit(float h);
+    void FinishStep(float h);
+    void Collide();
+    void CollideWithColliders();
+    void CollideRange(int begin, int end);
+    void Reorder();
+
+    //  drives UpdateRange and FinishStep for the fused update of many emitters
+    friend class ParticleSystem;
 };
 
-#endif // !PARTICLE_EMITTER_H
+/*
+    Integrates every live particle under the given forces
+    With a thread pool set, the live range is split into chunks that are
+    updated in parallel; every chunk only touches its own particles so the
+    result is identical to the serial update
+    Particles that died are then removed and new ones emitted
+*/
+template <class Integrator, class Forces>
+void ParticleEmitter::AddForce(const Forces& forces)
+{
+    PROFILE_SCOPE("ParticleEmitter::AddForce");
+    float h = m_timestep;
+
+    if (m_pool == NULL)
+        UpdateRange<Integrator>(0, m_liveCount, forces, h);
+    else
+        m_pool->ParallelFor(m_liveCount, PARTICLE_CHUNK_SIZE, [&](int begin, int end) {
+            UpdateRange<Integrator>(begin, end, forces, h);
+        });
 
+    FinishStep(h);
+}
+
+/*
+    Updates particles [begin, end)
+    The integrator and the force fields are inlined into the loop, so every
+    force is evaluated in one pass that streams position, velocity and life
+    without branches and the compiler vectorizes it
+*/
+template <class Integrator, class Forces>
+void ParticleEmitter::UpdateRange(int begin, int end, const Forces& forces, float h)
+{
+    float* __restrict x = m_particles.m_x;
+    float* __restrict y = m_particles.m_y;
+    float* __restrict z = m_particles.m_z;
+    float* __restrict vx = m_particles.m_vx;
+    float* __restrict vy = m_particles.m_vy;
+    float* __restrict vz = m_particles.m_vz;
+    float* __restrict life = m_particles.m_life;
+
+    //  local copy, so the compiler knows the stores below cannot change the forces
+    const Forces local = forces;
+
+    //  Advance position and velocity of each particle, reduce life by h
+    for (int i = begin; i < end; i++)
+    {
+        float px = x[i], py = y[i], pz = z[i];
+        float pvx = vx[i], pvy = vy[i], pvz = vz[i];
+
+        Integrator::Step(local, h, px, py, pz, pvx, pvy, pvz);
+
+        x[i] = px;
+        y[i] = py;
+        z[i] = pz;
+        vx[i] = pvx;
+        vy[i] = pvy;
+        vz[i] = pvz;
+
+        life[i] -= h;
+    }
+}
+
+/*
+    Adaptive step by step doubling
+    Trial steps are judged on the largest error over all live particles until
+    one is accepted, which is then applied as two half steps
+*/
+template <class Integrator, class Forces>
+float ParticleEmitter::AddForceAdaptive(const Forces& forces, AdaptiveStep& adaptive)
+{
+    PROFILE_SCOPE("ParticleEmitter::AddForceAdaptive");
+    float h = adaptive.step;
+    while (!adaptive.Update(h, EstimateError<Integrator>(forces, h), Integrator::Order))
+        h = adaptive.step;
+
+    float half = 0.5f * h;
+    auto update = [&](int begin, int end) {
+        UpdateRange<Integrator>(begin, end, forces, half);
+        UpdateRange<Integrator>(begin, end, forces, half);
+    };
+    if (m_pool == NULL)
+        update(0, m_liveCount);
+    else
+        m_pool->ParallelFor(m_liveCount, PARTICLE_CHUNK_SIZE, update);
+
+    FinishStep(h);
+    return h;
+}
+
+/*
+    Largest step doubling error of a trial step of h over the live particles
+    Every chunk writes its own slot, the slots are reduced afterwards so the
+    result does not depend on the thread count
+*/
+template <class Integrator, class Forces>
+float ParticleEmitter::EstimateError(const Forces& forces, float h)
+{
+    int chunks = (m_liveCount + PARTICLE_CHUNK_SIZE - 1) / PARTICLE_CHUNK_SIZE;
+    m_chunkError.assign(chunks, 0.0f);
+
+    auto estimate = [&](int begin, int end) {
+        m_chunkError[begin / PARTICLE_CHUNK_SIZE] = RangeError<Integrator>(begin, end, forces, h);
+    };
+    if (m_pool == NULL)
+    {
+        for (int begin = 0; begin < m_liveCount; begin += PARTICLE_CHUNK_SIZE)
+            estimate(begin, std::min(begin + PARTICLE_CHUNK_SIZE, m_liveCount));
+    }
+    else
+        m_pool->ParallelFor(m_liveCount, PARTICLE_CHUNK_SIZE, estimate);
+
+    float error = 0.0f;
+    for (int c = 0; c < chunks; c++)
+        error = std::max(error, m_chunkError[c]);
+    return AdaptiveStep::DoublingError(error, Integrator::Order);
+}
+
+//  Largest difference between one step of h and two of h/2 over particles [begin, end)
+template <class Integrator, class Forces>
+float ParticleEmitter::RangeError(int begin, int end, const Forces& forces, float h) const
+{
+    const float* __restrict x = m_particles.m_x;
+    const float* __restrict y = m_particles.m_y;
+    const float* __restrict z = m_particles.m_z;
+    const float* __restrict vx = m_particles.m_vx;
+    const float* __restrict vy = m_particles.m_vy;
+    const float* __restrict vz = m_particles.m_vz;
+
+    const Forces local = forces;
+    const float half = 0.5f * h;
+    float error = 0.0f;
+    for (int i = begin; i < end; i++)
+    {
+        float wx = x[i], wy = y[i], wz = z[i];
+        float wvx = vx[i], wvy = vy[i], wvz = vz[i];
+        Integrator::Step(local, h, wx, wy, wz, wvx, wvy, wvz);
+
+        float hx = x[i], hy = y[i], hz = z[i];
+        float hvx = vx[i], hvy = vy[i], hvz = vz[i];
+        Integrator::Step(local, half, hx, hy, hz, hvx, hvy, hvz);
+        Integrator::Step(local, half, hx, hy, hz, hvx, hvy, hvz);
+
+        //  position and velocity error, the latter as the distance it makes up over the step
+        float dx = hx - wx, dy = hy - wy, dz = hz - wz;
+        float dvx = hvx - wvx, dvy = hvy - wvy, dvz = hvz - wvz;
+        float position2 = dx * dx + dy * dy + dz * dz;
+        float velocity2 = h * h * (dvx * dvx + dvy * dvy + dvz * dvz);
+        error = std::max(error, std::max(position2, velocity2));
+    }
+    return std::sqrt(error);
+}
+
+#endif // !PARTICLE_EMITTER_H
@@ -15,13 +15,25 @@ C++, OpenGL, GLSL
 #include <glm/gtc/matrix_transform.hpp>
 
 //  C++ headers
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 //  Custon headers
 #include "Camera.h"
 #include "Shader.h"
 #include "Texture.h"
+#include "ColliderSet.h"
+#include "FixedTimestep.h"
+#include "IntegratorBenchmark.h"
 #include "ParticleEmitter.h"
+#include "ParticleSystem.h"
+#include "PerformanceOverlay.h"
+#include "Profiler.h"
+#include "SnapshotWriter.h"
+#include "ThreadPool.h"
 
 //  Callback function definitions
 void ProcessInput(GLFWwindow* window);
@@ -30,6 +42,9 @@ void MouseCallback(GLFWwindow* window, double x_pos, double y_pos);
 void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
 void ScrollCallback(GLFWwindow* window, double x_offSet, double y_offSet);
 
+//  Headless batch run
+void RunHeadless(ParticleSystem& pSim, SnapshotWriter& snapshots, const glm::vec3& gravity, int steps, float tolerance);
+
 //  Screen
 const unsigned int SCREEN_WIDTH = 1280;
 const unsigned int SCREEN_HEIGHT = 720;
@@ -46,7 +61,127 @@ bool keys[1024];
 bool firstMouse = true;
 bool mouseClickActive = false;
 
-int main() {
+//  Performance HUD
+PerformanceOverlay overlay;
+
+int main(int argc, char** argv) {
+
+    //  Command line
+    //  --headless      run the simulation without a window or GL context
+    //  --steps N       number of steps for the headless run
+    //  --threads N     simulation threads, 0 uses one per core and 1 updates serially
+    //  --snapshot FILE write binary particle snapshots to FILE
+    //  --snapshot-interval N   steps between two snapshots
+    //  --rate N        particles emitted per second, default keeps the pool full
+    //  --radius R      particle radius for particle-particle collisions, 0 disables them
+    //  --reorder N     sort the particles along a Morton curve every N steps, 0 disables it
+    //  --emitters N    split the particles over N emitters updated together
+    //  --timestep H    simulated seconds per step
+    //  --floor Y       particles bounce off a floor plane at height Y
+    //  --adaptive TOL  headless run covers the time of N steps with adaptive steps of the given error tolerance
+    //  --trace FILE    write the profiler zones as a Chrome trace on exit, needs the Profile build
+    //  --integrator-benchmark  compare the accuracy and cost of the integrators and exit
+    bool headless = false;
+    int steps = 1000;
+    int threadCount = 0;
+    const char* snapshotPath = NULL;
+    int snapshotInterval = 10;
+    float emissionRate = -1.0f;
+    float collisionRadius = 0.0f;
+    int reorderInterval = 0;
+    int emitterCount = 1;
+    float timestep = 0.01f;
+    bool floor = false;
+    float floorHeight = 0.0f;
+    bool integratorBenchmark = false;
+    float tolerance = 0.0f;
+    const char* tracePath = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0)
+            headless = true;
+        else if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+            steps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threadCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc)
+            snapshotPath = argv[++i];
+        else if (strcmp(argv[i], "--snapshot-interval") == 0 && i + 1 < argc)
+            snapshotInterval = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc)
+            emissionRate = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--radius") == 0 && i + 1 < argc)
+            collisionRadius = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--reorder") == 0 && i + 1 < argc)
+            reorderInterval = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--emitters") == 0 && i + 1 < argc)
+            emitterCount = std::min(PARTICLE_MAX_EMITTERS, std::max(1, atoi(argv[++i])));
+        else if (strcmp(argv[i], "--timestep") == 0 && i + 1 < argc)
+            timestep = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--floor") == 0 && i + 1 < argc) {
+            floor = true;
+            floorHeight = (float)atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--adaptive") == 0 && i + 1 < argc)
+            tolerance = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            tracePath = argv[++i];
+        else if (strcmp(argv[i], "--integrator-benchmark") == 0)
+            integratorBenchmark = true;
+        else
+            std::cout << "Ignoring unknown argument " << argv[i] << std::endl;
+    }
+
+    PROFILE_THREAD("Main");
+
+    if (integratorBenchmark) {
+        RunIntegratorBenchmark();
+        return 0;
+    }
+
+    //  Environment properties
+    glm::vec3 gravity(0.0f, -9.8f, 0.0f);
+
+    //  Particle properties
+    int pCount = 50000;
+    glm::vec3 position(0.0f, 0.0f, 0.0f);
+    glm::vec3 velocity(5.0f, 0.0f, 0.0f);
+    float velocityVariance = 0.0f;
+    float life = 10.0f;                 //  seconds
+    float lifeVariance = 0.0f;
+
+    ThreadPool pool(threadCount);
+
+    //  Static colliders shared by every emitter
+    ColliderSet colliders;
+    if (floor)
+        colliders.AddPlane(glm::vec3(0.0f, floorHeight, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    //  Creating particle sim object, emitters side by side along z
+    ParticleSystem pSim(pCount + emitterCount * PARTICLE_VIEW_GRANULARITY);
+    pSim.SetThreadPool(&pool);
+    pSim.SetTimestep(timestep);
+    for (int e = 0; e < emitterCount; e++) {
+        glm::vec3 offset(0.0f, 0.0f, 2.0f * (e - (emitterCount - 1) / 2.0f));
+        ParticleEmitter* emitter = pSim.AddEmitter(pCount / emitterCount, position + offset, velocity, velocityVariance, life, lifeVariance);
+        if (emissionRate >= 0.0f)
+            emitter->SetEmissionRate(emissionRate / emitterCount);
+        emitter->SetCollisionRadius(collisionRadius);
+        emitter->SetReorderInterval(reorderInterval);
+        if (colliders.GetPlaneCount() > 0)
+            emitter->SetColliders(&colliders);
+    }
+
+    //  Particle state dump, written on a background thread
+    SnapshotWriter snapshots;
+    if (snapshotPath != NULL)
+        snapshots.Open(snapshotPath, snapshotInterval);
+
+    if (headless) {
+        RunHeadless(pSim, snapshots, gravity, steps, tolerance);
+        if (tracePath != NULL)
+            Profiler::WriteChromeTrace(tracePath);
+        return 0;
+    }
 
     //  GLFW: Initialization
     glfwInit();
@@ -78,51 +213,144 @@ int main() {
     //  Enable depth testing
     glEnable(GL_DEPTH_TEST);
 
-    //  Environment properties
-    glm::vec3 gravity(0.0f, -9.8f, 0.0f);
+    overlay.Init(window);
 
-    //  Particle properties
-    int pCount = 50000;
-    glm::vec3 position(0.0f, 0.0f, 0.0f);
-    glm::vec3 velocity(5.0f, 0.0f, 0.0f);
-    float velocityVariance = 0.0f;
-    float life = 10.0f;
-    float lifeVariance = 0.0f;
+    //  Physics runs in fixed steps whatever the frame rate
+    //  Particles are not drawn yet, so there is no state to interpolate with clock.GetAlpha()
+    FixedTimestep clock(pSim.GetTimestep());
 
-    //  Creating particle sim object
-    ParticleEmitter pSim(pCount,position,velocity,velocityVariance,life,lifeVariance);
+    //  Runtime controls of the overlay, the particle count sets the emission
+    //  rate that keeps that many particles alive
+    int targetCount = emissionRate >= 0.0f ? std::min(pCount, (int)(emissionRate * life)) : pCount;
+    int overlayThreads = pool.GetThreadCount();
+    OverlayControls controls;
+    controls.count = &targetCount;
+    controls.maxCount = pCount;
+    controls.countLabel = "Particles";
+    controls.threads = &overlayThreads;
+    controls.maxThreads = std::max(1, (int)std::thread::hardware_concurrency());
+    controls.timestep = &timestep;
 
     while (!glfwWindowShouldClose(window)) {
+        PROFILE_SCOPE("Frame");
 
         //  per-frame time logic
         float currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
+        overlay.NewFrame(deltaTime);
 
         //  Process input
-        ProcessInput(window);
+        {
+            PROFILE_SCOPE("Input");
+            ProcessInput(window);
+        }
 
+        unsigned long long renderStart = Profiler::Now();
         glClearColor(0.2, 0.2, 0.2, 1.0);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         //  projection and view matrix Set
         glm::mat4 projection = glm::perspective(camera.Zoom, (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT, 0.1f, 100.0f);
         glm::mat4 view = camera.GetViewMatrix();
+        unsigned long long simulationStart = Profiler::Now();
+        overlay.SetRenderTime((simulationStart - renderStart) * 1.0e-6f);
 
         //  Simulation takes place here
-        pSim.AddForce(gravity);
-        pSim.PrintDetails();
+        int substeps = clock.Advance(deltaTime);
+        for (int i = 0; i < substeps; i++) {
+            PROFILE_SCOPE("Simulation");
+            pSim.AddForce(gravity);
+            snapshots.Capture(pSim);
+        }
+        overlay.SetSimulation((Profiler::Now() - simulationStart) * 1.0e-6f, substeps);
+        overlay.SetBodyCount(pSim.GetLiveCount(), pSim.GetCapacity());
+
+        //  changes apply from the next step
+        if (overlay.Draw(controls)) {
+            for (int e = 0; e < pSim.GetEmitterCount(); e++)
+                pSim.GetEmitter(e)->SetEmissionRate(targetCount / (float)pSim.GetEmitterCount() / life);
+            //  resizing joins and respawns the workers, only do it for a new count,
+            //  the pool is idle here between the steps of two frames
+            if (overlayThreads != pool.GetThreadCount())
+                pool.SetThreadCount(overlayThreads);
+            pSim.SetTimestep(timestep);
+            clock.SetStep(timestep);
+        }
 
         //  Swap buffers and poll IO events
+        PROFILE_SCOPE("SwapBuffers");
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
+    if (tracePath != NULL)
+        Profiler::WriteChromeTrace(tracePath);
+
     //  terminate
+    overlay.Shutdown();
     glfwTerminate();
     return 0;
 }
 
+/*
+    Runs the simulation for a fixed number of steps without any rendering
+    and reports the throughput
+*/
+void RunHeadless(ParticleSystem& pSim, SnapshotWriter& snapshots, const glm::vec3& gravity, int steps, float tolerance) {
+    std::cout << "Headless run: " << pSim.GetEmitterCount() << " emitters, " << pSim.GetCapacity() << " particle capacity, " << steps << " steps" << std::endl;
+
+    //  live particles can change every step
+    double particleSteps = 0.0;
+
+    //  the adaptive run covers the simulated time of the fixed steps, up to 10 fixed steps at a time
+    AdaptiveStep adaptive(tolerance, pSim.GetTimestep() * 0.01f, pSim.GetTimestep() * 10.0f);
+    double duration = steps * (double)pSim.GetTimestep();
+    int fixedSteps = steps;
+
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    if (tolerance > 0.0f) {
+        //  the last step is cut short to end on the same simulated time
+        float maxStep = adaptive.maxStep;
+        steps = 0;
+        for (double t = 0.0; t < duration - 1.0e-6; steps++) {
+            particleSteps += pSim.GetLiveCount();
+            adaptive.maxStep = std::min(maxStep, (float)(duration - t));
+            t += pSim.AddForceAdaptive(Gravity(gravity), adaptive);
+            snapshots.Capture(pSim);
+        }
+    }
+    else {
+        for (int i = 0; i < steps; i++) {
+            particleSteps += pSim.GetLiveCount();
+            pSim.AddForce(gravity);
+            snapshots.Capture(pSim);
+        }
+    }
+    std::chrono::high_resolution_clock::time_point stop = std::chrono::high_resolution_clock::now();
+
+    double seconds = std::chrono::duration<double>(stop - start).count();
+    double stepsPerSecond = seconds > 0.0 ? steps / seconds : 0.0;
+
+    std::cout << "Wall time: " << seconds << " s" << std::endl;
+    std::cout << "Steps/sec: " << stepsPerSecond << std::endl;
+    std::cout << "Particle steps/sec: " << (seconds > 0.0 ? particleSteps / seconds : 0.0) << std::endl;
+    if (tolerance > 0.0f)
+        std::cout << "Adaptive steps: " << adaptive.accepted << " accepted, " << adaptive.rejected << " rejected, instead of " << fixedSteps << std::endl;
+
+    double reorderTime = 0.0;
+    for (int e = 0; e < pSim.GetEmitterCount(); e++)
+        reorderTime += pSim.GetEmitter(e)->GetLastReorderTime();
+    if (reorderTime > 0.0)
+        std::cout << "Last reorder: " << reorderTime << " ms" << std::endl;
+
+    if (snapshots.IsOpen()) {
+        snapshots.Close();
+        std::cout << "Snapshots written: " << snapshots.GetWrittenCount() << ", dropped: " << snapshots.GetDroppedCount()
+            << (snapshots.HasFailed() ? " after a write error" : "") << std::endl;
+    }
+}
+
 /*
     Whenever the window size is changed (automatically by OS, or manually by user) this function is called
 */
@@ -172,6 +400,12 @@ void MouseCallback(GLFWwindow* window, double x_pos, double y_pos) {
     Activates mouse when left button is clicked
 */
 void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+    overlay.OnMouseButton(window, button, action, mods);
+    if (overlay.WantsMouse()) {
+        mouseClickActive = false;
+        return;
+    }
+
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
         mouseClickActive = true;
     else
@@ -182,6 +416,9 @@ void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
     Whenever mouse scroll wheel is used, this function is called
 */
 void ScrollCallback(GLFWwindow* window, double x_offSet, double y_offSet) {
+    overlay.OnScroll(window, x_offSet, y_offSet);
+    if (overlay.WantsMouse())
+        return;
     camera.ProcessMouseScroll(y_offSet);
 }
 
@@ -0,0 +1,131 @@
+/*
+    Implementation of PARTICLE_SYSTEM_H
+*/
+
+#include "ParticleSystem.h"
+#include <algorithm>
+
+ParticleSystem::ParticleSystem(int capacity) :
+    m_capacity(capacity), m_used(0), m_timestep(0.01f), m_pool(NULL)
+{
+    m_arena.Allocate(m_capacity);
+}
+
+ParticleSystem::~ParticleSystem()
+{
+    for (size_t i = 0; i < m_emitters.size(); i++)
+        delete m_emitters[i];
+}
+
+ParticleEmitter* ParticleSystem::AddEmitter(int maxCount, glm::vec3 pos, glm::vec3 vel, float velVariance, float life, float lifeVariance)
+{
+    if (maxCount <= 0 || m_used + maxCount > m_capacity)
+        return NULL;
+    //  past this the index would wrap in the ids and collide with the first emitters
+    if ((int)m_emitters.size() >= PARTICLE_MAX_EMITTERS)
+        return NULL;
+
+    ParticleEmitter* emitter = new ParticleEmitter(m_arena, m_used, maxCount, pos, vel, velVariance, life, lifeVariance);
+    unsigned int index = (unsigned int)m_emitters.size();
+    emitter->SetThreadPool(m_pool);
+    emitter->SetStream(index);
+    emitter->SetIdBase(index << PARTICLE_ID_SERIAL_BITS, PARTICLE_ID_SERIAL_BITS);
+    m_emitters.push_back(emitter);
+
+    //  keep the next slice cache line aligned
+    m_used += (maxCount + PARTICLE_VIEW_GRANULARITY - 1) / PARTICLE_VIEW_GRANULARITY * PARTICLE_VIEW_GRANULARITY;
+    m_used = std::min(m_used, m_capacity);
+    return emitter;
+}
+
+void ParticleSystem::SetThreadPool(ThreadPool* pool)
+{
+    m_pool = pool;
+    for (size_t i = 0; i < m_emitters.size(); i++)
+        m_emitters[i]->SetThreadPool(pool);
+}
+
+/*
+    Cuts the live ranges of all emitters into work items of about
+    PARTICLE_CHUNK_SIZE particles
+*/
+void ParticleSystem::BuildWorkItems()
+{
+    m_segments.clear();
+    m_itemStart.clear();
+    m_itemStart.push_back(0);
+
+    int itemSize = 0;
+    for (size_t e = 0; e < m_emitters.size(); e++)
+    {
+        ParticleEmitter* emitter = m_emitters[e];
+        int live = emitter->GetLiveCount();
+        int begin = 0;
+        while (begin < live)
+        {
+            int end = std::min(live, begin + PARTICLE_CHUNK_SIZE - itemSize);
+            Segment segment = { emitter, begin, end };
+            m_segments.push_back(segment);
+            itemSize += end - begin;
+            begin = end;
+
+            if (itemSize == PARTICLE_CHUNK_SIZE)
+            {
+                m_itemStart.push_back((int)m_segments.size());
+                itemSize = 0;
+            }
+        }
+    }
+    if (itemSize > 0)
+        m_itemStart.push_back((int)m_segments.size());
+}
+
+void ParticleSystem::AddForce(const glm::vec3& gravity)
+{
+    AddForce(Gravity(gravity));
+}
+
+/*
+    Finishes the step of every emitter after the fused integration
+    The emitters use the pool themselves for collisions and reordering,
+    so they are finished one after the other
+*/
+void ParticleSystem::FinishStep(float h)
+{
+    for (size_t e = 0; e < m_emitters.size(); e++)
+        m_emitters[e]->FinishStep(h);
+}
+
+void ParticleSystem::SetTimestep(float h)
+{
+    if (h > 0.0f)
+        m_timestep = h;
+}
+
+float ParticleSystem::GetTimestep() const
+{
+    return m_timestep;
+}
+
+int ParticleSystem::GetEmitterCount() const
+{
+    return (int)m_emitters.size();
+}
+
+ParticleEmitter* ParticleSystem::GetEmitter(int i) const
+{
+    return m_emitters[i];
+}
+
+int ParticleSystem::GetCapacity() const
+{
+    return m_capacity;
+}
+
+int ParticleSystem::GetLiveCount() const
+{
+    int live = 0;
+    for (size_t e = 0; e < m_emitters.size(); e++)
+        live += m_emitters[e]->GetLiveCount();
+    return live;
+}
@@ -0,0 +1,145 @@
+#pragma once
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include "ParticleEmitter.h"
+#include <vector>
+
+//  Particle ids of a system hold the emitter index above this many bits of spawn serial
+const int PARTICLE_ID_SERIAL_BITS = 22;
+//  Emitters whose index still fits above the serial in a 32 bit id
+const int PARTICLE_MAX_EMITTERS = 1 << (32 - PARTICLE_ID_SERIAL_BITS);
+
+/*
+    Owns many emitters whose particles all live in one shared arena and
+    updates them together
+
+    The integration of every emitter runs in a single parallel pass: the
+    live ranges of all emitters are cut into work items of about
+    PARTICLE_CHUNK_SIZE particles, small emitters sharing an item, so
+    hundreds of small emitters keep every thread busy. The per-emitter
+    bookkeeping (killing, emission, reordering, collisions) follows
+    emitter by emitter.
+*/
+class ParticleSystem
+{
+public:
+    //  capacity is the total number of particles over all emitters
+    explicit ParticleSystem(int capacity);
+    ~ParticleSystem();
+
+    //  Carves a new emitter out of the arena, NULL when the arena is full or
+    //  the system already has PARTICLE_MAX_EMITTERS emitters
+    //  Its random stream and particle ids are keyed on its index, so ids are
+    //  unique until one emitter spawns 2^22 particles
+    ParticleEmitter* AddEmitter(int maxCount, glm::vec3 pos, glm::vec3 vel, float velVariance, float life, float lifeVariance);
+
+    void SetThreadPool(ThreadPool* pool);
+    void AddForce(const glm::vec3& gravity);
+    template <class Integrator = VelocityVerlet, class Forces>
+    void AddForce(const Forces& forces);
+
+    //  One step of a size chosen by adaptive for all emitters together,
+    //  returns the simulated time it advanced
+    template <class Integrator = VelocityVerlet, class Forces>
+    float AddForceAdaptive(const Forces& forces, AdaptiveStep& adaptive);
+
+    //  Simulated time advanced by each AddForce, the same for every emitter
+    void SetTimestep(float h);
+    float GetTimestep() const;
+
+    int GetEmitterCount() const;
+    ParticleEmitter* GetEmitter(int i) const;
+    int GetCapacity() const;
+    int GetLiveCount() const;
+
+private:
+    //  a piece of one emitter's live range
+    struct Segment
+    {
+        ParticleEmitter* emitter;
+        int begin;
+        int end;
+    };
+
+    ParticleData m_arena;
+    int m_capacity;
+    int m_used;
+    float m_timestep;
+
+    std::vector<ParticleEmitter*> m_emitters;
+    ThreadPool* m_pool;
+
+    //  work items of the fused pass, item k is m_segments[m_itemStart[k] .. m_itemStart[k + 1])
+    std::vector<Segment> m_segments;
+    std::vector<int> m_itemStart;
+
+    void BuildWorkItems();
+    template <class Integrator, class Forces>
+    void Integrate(const Forces& forces, float h);
+    void FinishStep(float h);
+
+    ParticleSystem(const ParticleSystem&);
+    ParticleSystem& operator=(const ParticleSystem&);
+};
+
+/*
+    One step of every emitter under the same forces
+    Integration is one fused parallel pass over all emitters; the rest of
+    the step is done per emitter
+*/
+template <class Integrator, class Forces>
+void ParticleSystem::AddForce(const Forces& forces)
+{
+    PROFILE_SCOPE("ParticleSystem::AddForce");
+    float h = m_timestep;
+    Integrate<Integrator>(forces, h);
+    FinishStep(h);
+}
+
+/*
+    Adaptive step by step doubling, judged on the largest error over every
+    emitter so all of them stay at the same simulated time
+*/
+template <class Integrator, class Forces>
+float ParticleSystem::AddForceAdaptive(const Forces& forces, AdaptiveStep& adaptive)
+{
+    PROFILE_SCOPE("ParticleSystem::AddForceAdaptive");
+    float h;
+    for (;;)
+    {
+        h = adaptive.step;
+        float error = 0.0f;
+        for (size_t e = 0; e < m_emitters.size(); e++)
+            error = std::max(error, m_emitters[e]->EstimateError<Integrator>(forces, h));
+        if (adaptive.Update(h, error, Integrator::Order))
+            break;
+    }
+
+    Integrate<Integrator>(forces, 0.5f * h);
+    Integrate<Integrator>(forces, 0.5f * h);
+    FinishStep(h);
+    return h;
+}
+
+//  Integration of every emitter in one fused parallel pass
+template <class Integrator, class Forces>
+void ParticleSystem::Integrate(const Forces& forces, float h)
+{
+    BuildWorkItems();
+    int items = (int)m_itemStart.size() - 1;
+
+    auto integrate = [&](int begin, int end) {
+        for (int item = begin; item < end; item++)
+        {
+            for (int s = m_itemStart[item]; s < m_itemStart[item + 1]; s++)
+                m_segments[s].emitter->UpdateRange<Integrator>(m_segments[s].begin, m_segments[s].end, forces, h);
+        }
+    };
+    if (m_pool == NULL)
+        integrate(0, items);
+    else
+        m_pool->ParallelFor(items, 1, integrate);
+}
+
+#endif // !PARTICLE_SYSTEM_H
@@ -0,0 +1,95 @@
+#pragma once
+#ifndef PERFORMANCE_OVERLAY_H
+#define PERFORMANCE_OVERLAY_H
+
+struct GLFWwindow;
+
+//  Number of frames shown in the frame time histogram
+const int OVERLAY_FRAME_HISTORY = 120;
+
+/*
+    Values the overlay lets the user change at runtime
+    A NULL pointer hides its control. Draw returns true when one of them
+    changed, the caller then applies the new values.
+*/
+struct OverlayControls
+{
+    int* count;             //  particles or balls
+    int maxCount;
+    const char* countLabel;
+    int* threads;
+    int maxThreads;
+    float* timestep;
+
+    OverlayControls() : count(0), maxCount(0), countLabel("Count"), threads(0), maxThreads(1), timestep(0) {}
+};
+
+/*
+    Performance HUD drawn with the vendored Dear ImGui
+
+    Shows the frame time of the last OVERLAY_FRAME_HISTORY frames as a
+    histogram, the time spent simulating against the time spent rendering,
+    the simulation step rate, the number of live bodies and the memory used
+    by the process, and has controls for the body count, the thread count
+    and the timestep. F1 shows and hides it.
+
+    Every frame
+        overlay.NewFrame(deltaTime);
+        ...simulate, overlay.SetSimulation(ms, steps)...
+        ...render, overlay.SetRenderTime(ms)...
+        if (overlay.Draw(controls)) apply the controls
+*/
+class PerformanceOverlay
+{
+public:
+    PerformanceOverlay();
+
+    //  Needs the GL context of window to be current
+    void Init(GLFWwindow* window);
+    void Shutdown();
+
+    //  Starts the frame, frameTime is the time since the last frame in seconds
+    void NewFrame(float frameTime);
+
+    //  Time spent simulating this frame in ms and the steps taken
+    void SetSimulation(float milliseconds, int steps);
+    //  Time spent rendering the scene in ms
+    void SetRenderTime(float milliseconds);
+    void SetBodyCount(int live, int capacity);
+
+    //  Builds and renders the overlay, returns true when a control changed
+    bool Draw(OverlayControls& controls);
+
+    //  Input forwarded by the application's GLFW callbacks
+    void OnMouseButton(GLFWwindow* window, int button, int action, int mods);
+    void OnScroll(GLFWwindow* window, double x_offSet, double y_offSet);
+    //  True while the mouse is over the overlay, the camera should ignore it then
+    bool WantsMouse() const;
+
+    bool IsVisible() const;
+
+private:
+    GLFWwindow* m_window;
+    bool m_initialized;
+    bool m_visible;
+    bool m_toggleHeld;
+
+    float m_frameTimes[OVERLAY_FRAME_HISTORY];     //  ms, ring buffer
+    int m_frameIndex;
+
+    float m_simulationTime;
+    float m_renderTime;
+
+    //  steps counted over about a second for the step rate
+    int m_stepCount;
+    float m_stepWindow;
+    float m_stepRate;
+
+    int m_liveCount;
+    int m_capacity;
+};
+
+//  Resident memory of the process in bytes, 0 when unknown
+unsigned long long GetProcessMemoryUsage();
+
+#endif // !PERFORMANCE_OVERLAY_H
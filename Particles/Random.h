@@ -0,0 +1,91 @@
+#pragma once
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <stdint.h>
+
+/*
+    Philox 4x32-10 counter-based random number generator
+    (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3")
+
+    There is no generator state: the output is a pure function of a 128-bit
+    counter and a 64-bit key, so any thread can draw the numbers of any
+    particle in any order and always get the same values.
+*/
+namespace Random
+{
+    const uint32_t PHILOX_M0 = 0xD2511F53u;
+    const uint32_t PHILOX_M1 = 0xCD9E8D57u;
+    const uint32_t PHILOX_W0 = 0x9E3779B9u;
+    const uint32_t PHILOX_W1 = 0xBB67AE85u;
+
+    inline void MulHiLo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo)
+    {
+        uint64_t product = (uint64_t)a * (uint64_t)b;
+        hi = (uint32_t)(product >> 32);
+        lo = (uint32_t)product;
+    }
+
+    //  Ten rounds of Philox on counter c with key k, result written to out
+    inline void Philox4x32(const uint32_t c[4], const uint32_t k[2], uint32_t out[4])
+    {
+        uint32_t c0 = c[0], c1 = c[1], c2 = c[2], c3 = c[3];
+        uint32_t k0 = k[0], k1 = k[1];
+
+        for (int round = 0; round < 10; round++)
+        {
+            uint32_t hi0, lo0, hi1, lo1;
+            MulHiLo(PHILOX_M0, c0, hi0, lo0);
+            MulHiLo(PHILOX_M1, c2, hi1, lo1);
+
+            c0 = hi1 ^ c1 ^ k0;
+            c1 = lo1;
+            c2 = hi0 ^ c3 ^ k1;
+            c3 = lo0;
+
+            k0 += PHILOX_W0;
+            k1 += PHILOX_W1;
+        }
+
+        out[0] = c0;
+        out[1] = c1;
+        out[2] = c2;
+        out[3] = c3;
+    }
+
+    //  Maps 32 random bits to a float in [0, 1)
+    inline float ToUniform(uint32_t bits)
+    {
+        return (bits >> 8) * (1.0f / 16777216.0f);
+    }
+
+    //  Maps 32 random bits to a float in [-1, 1)
+    inline float ToSigned(uint32_t bits)
+    {
+        return ToUniform(bits) * 2.0f - 1.0f;
+    }
+
+    /*
+        Fills out[4 * i + j], j = 0..3 with signed uniforms in [-1, 1) for the
+        counters (first + i, stream) of a whole batch. Every iteration is
+        independent, so the loop vectorizes across the batch.
+    */
+    inline void SignedBatch(uint32_t seed, uint32_t stream, uint64_t first, int count, float* out)
+    {
+        const uint32_t key[2] = { seed, stream };
+        for (int i = 0; i < count; i++)
+        {
+            uint64_t n = first + (uint64_t)i;
+            uint32_t counter[4] = { (uint32_t)n, (uint32_t)(n >> 32), 0u, 0u };
+            uint32_t bits[4];
+            Philox4x32(counter, key, bits);
+
+            out[4 * i + 0] = ToSigned(bits[0]);
+            out[4 * i + 1] = ToSigned(bits[1]);
+            out[4 * i + 2] = ToSigned(bits[2]);
+            out[4 * i + 3] = ToSigned(bits[3]);
+        }
+    }
+}
+
+#endif // !RANDOM_H
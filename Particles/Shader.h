@@ -3,9 +3,11 @@
 #define SHADER_H
 
 #include<string.h>
+#include<string>
 #include<fstream>
 #include<sstream>
 #include<iostream>
+#include<unordered_map>
 using namespace std;
 
 // For opengl headers
@@ -35,7 +37,12 @@ public:
     //  use the program
     void Use();
 
-    //  Set uniforms
+    //  Location of an active uniform from the table built at link time, -1
+    //  when the program has no such uniform
+    GLint GetUniform(const std::string &name) const;
+    int GetUniformCount() const;
+
+    //  Set uniforms by name, looked up in the table
     void SetBool(const std::string &name, bool value) const;
     void SetInt(const std::string &name, int value) const;
     void SetFloat(const std::string &name, float value) const;
@@ -47,7 +54,25 @@ public:
     void SetMat3(const std::string &name, const glm::mat3 &mat) const;
     void SetMat4(const std::string &name, const glm::mat4 &mat) const;
 
+    //  Set uniforms by a location from GetUniform, for the per-frame and
+    //  per-object uniforms
+    void SetBool(GLint location, bool value) const;
+    void SetInt(GLint location, int value) const;
+    void SetFloat(GLint location, float value) const;
+    void SetVec2(GLint location, const glm::vec2 &value) const;
+    void SetVec2(GLint location, float x, float y) const;
+    void SetVec3(GLint location, const glm::vec3 &value) const;
+    void SetVec3(GLint location, float x, float y, float z) const;
+    void SetMat2(GLint location, const glm::mat2 &mat) const;
+    void SetMat3(GLint location, const glm::mat3 &mat) const;
+    void SetMat4(GLint location, const glm::mat4 &mat) const;
+
 private:
+    //  reads the active uniforms of the linked program into the table
+    void LoadUniforms();
+
+    //  uniform name -> location
+    std::unordered_map<std::string, GLint> m_uniforms;
 
 };
 
@@ -0,0 +1,260 @@
+/*
+    Implementation of SNAPSHOT_WRITER_H
+*/
+
+#include "SnapshotWriter.h"
+#include <cstring>
+#include <iostream>
+
+const unsigned int SNAPSHOT_VERSION = 1;
+
+SnapshotWriter::SnapshotWriter() :
+    m_interval(1), m_step(0), m_written(0), m_dropped(0), m_failed(false), m_quit(false)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        m_frames[i].state = BUFFER_FREE;
+        m_frames[i].step = 0;
+        m_frames[i].count = 0;
+    }
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+    Close();
+}
+
+bool SnapshotWriter::Open(const std::string& path, int interval)
+{
+    Close();
+
+    m_file.open(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!m_file.is_open())
+    {
+        std::cout << "ERROR::SNAPSHOT::FILE_NOT_OPENED " << path << std::endl;
+        return false;
+    }
+
+    m_file.write("PSNP", 4);
+    m_file.write((const char*)&SNAPSHOT_VERSION, sizeof(SNAPSHOT_VERSION));
+    if (!m_file)
+    {
+        std::cout << "ERROR::SNAPSHOT::WRITE_FAILED " << path << std::endl;
+        m_file.close();
+        return false;
+    }
+
+    m_interval = interval < 1 ? 1 : interval;
+    m_step = 0;
+    m_written = 0;
+    m_dropped = 0;
+    m_failed = false;
+    m_path = path;
+    m_quit = false;
+    m_thread = std::thread(&SnapshotWriter::WriterLoop, this);
+    return true;
+}
+
+/*
+    Flushes the pending snapshots and stops the writer thread
+*/
+void SnapshotWriter::Close()
+{
+    if (!m_thread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_one();
+    m_thread.join();
+
+    //  the last buffered bytes only reach the disk here
+    m_file.close();
+    if (m_file.fail() && !m_failed)
+    {
+        std::cout << "ERROR::SNAPSHOT::WRITE_FAILED " << m_path << std::endl;
+        m_failed = true;
+    }
+
+    for (int i = 0; i < 2; i++)
+        m_frames[i].state = BUFFER_FREE;
+}
+
+bool SnapshotWriter::IsOpen() const
+{
+    return m_thread.joinable();
+}
+
+void SnapshotWriter::Capture(const ParticleData& particles, int count)
+{
+    const ParticleData* parts[1] = { &particles };
+    CaptureParts(parts, &count, 1);
+}
+
+/*
+    Captures the live particles of every emitter of the system as one frame
+*/
+void SnapshotWriter::Capture(const ParticleSystem& system)
+{
+    int emitters = system.GetEmitterCount();
+    std::vector<const ParticleData*> parts(emitters);
+    std::vector<int> counts(emitters);
+    for (int e = 0; e < emitters; e++)
+    {
+        parts[e] = &system.GetEmitter(e)->GetParticles();
+        counts[e] = system.GetEmitter(e)->GetLiveCount();
+    }
+    if (emitters > 0)
+        CaptureParts(&parts[0], &counts[0], emitters);
+}
+
+/*
+    Packs the first counts[p] particles of every part into one frame
+*/
+void SnapshotWriter::CaptureParts(const ParticleData* const* parts, const int* counts, int partCount)
+{
+    if (!IsOpen())
+        return;
+
+    unsigned int step = m_step++;
+    if (step % m_interval != 0)
+        return;
+
+    //  Find a staging buffer the writer is not using
+    Frame* frame = NULL;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_failed)
+        {
+            m_dropped++;
+            return;
+        }
+        for (int i = 0; i < 2; i++)
+        {
+            if (m_frames[i].state == BUFFER_FREE)
+            {
+                frame = &m_frames[i];
+                break;
+            }
+        }
+        if (frame == NULL)
+        {
+            m_dropped++;
+            return;
+        }
+    }
+
+    int count = 0;
+    for (int p = 0; p < partCount; p++)
+        count += counts[p];
+
+    //  Only the simulation thread touches free buffers, copy without the lock
+    frame->step = step;
+    frame->count = count;
+    frame->floats.resize(7 * (size_t)count);
+    frame->pids.resize(count);
+
+    int offset = 0;
+    for (int p = 0; p < partCount; p++)
+    {
+        const ParticleData& particles = *parts[p];
+        int n = counts[p];
+        if (n == 0)
+            continue;
+
+        const float* arrays[7] = { particles.m_x, particles.m_y, particles.m_z, particles.m_vx, particles.m_vy, particles.m_vz, particles.m_life };
+        for (int a = 0; a < 7; a++)
+            memcpy(&frame->floats[0] + (size_t)a * count + offset, arrays[a], n * sizeof(float));
+        memcpy(&frame->pids[0] + offset, particles.m_pid, n * sizeof(int));
+        offset += n;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        frame->state = BUFFER_PENDING;
+    }
+    m_wake.notify_one();
+}
+
+void SnapshotWriter::WriterLoop()
+{
+    for (;;)
+    {
+        Frame* frame = NULL;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            for (;;)
+            {
+                //  oldest pending frame first
+                for (int i = 0; i < 2; i++)
+                {
+                    if (m_frames[i].state == BUFFER_PENDING && (frame == NULL || m_frames[i].step < frame->step))
+                        frame = &m_frames[i];
+                }
+                if (frame != NULL || m_quit)
+                    break;
+                m_wake.wait(lock);
+            }
+            if (frame == NULL)
+                return;
+            frame->state = BUFFER_WRITING;
+        }
+
+        //  After a failure the file is not extended any more
+        bool failed;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            failed = m_failed;
+        }
+        bool written = !failed && WriteFrame(*frame);
+        if (!written && !failed)
+            std::cout << "ERROR::SNAPSHOT::WRITE_FAILED " << m_path << std::endl;
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            frame->state = BUFFER_FREE;
+            if (written)
+                m_written++;
+            else
+            {
+                m_failed = true;
+                m_dropped++;
+            }
+        }
+    }
+}
+
+/*
+    Returns false if the stream failed, a full disk for instance
+*/
+bool SnapshotWriter::WriteFrame(const Frame& frame)
+{
+    m_file.write((const char*)&frame.step, sizeof(frame.step));
+    m_file.write((const char*)&frame.count, sizeof(frame.count));
+    if (frame.count > 0)
+    {
+        m_file.write((const char*)&frame.floats[0], frame.floats.size() * sizeof(float));
+        m_file.write((const char*)&frame.pids[0], frame.pids.size() * sizeof(int));
+    }
+    return !m_file.fail();
+}
+
+int SnapshotWriter::GetWrittenCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_written;
+}
+
+int SnapshotWriter::GetDroppedCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dropped;
+}
+
+bool SnapshotWriter::HasFailed() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_failed;
+}
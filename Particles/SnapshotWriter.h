@@ -0,0 +1,92 @@
+#pragma once
+#ifndef SNAPSHOT_WRITER_H
+#define SNAPSHOT_WRITER_H
+
+#include "ParticleData.h"
+#include "ParticleSystem.h"
+
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+    Writes particle snapshots to a binary file on a background thread
+
+    File layout, in the byte order of the host that wrote it (little endian
+    on every platform this builds for); a reader can tell from the version
+        file header     char magic[4] = "PSNP", uint32 version
+        per frame       uint32 step, uint32 count,
+                        float x[count], y[count], z[count],
+                        float vx[count], vy[count], vz[count],
+                        float life[count], int32 pid[count]
+
+    Capture copies the particle state into one of two staging buffers and
+    returns; the writer thread drains the buffers to disk. If both buffers are
+    still waiting on the disk the snapshot is dropped rather than stalling
+    the simulation. Once a write fails the error is reported and every
+    later snapshot is dropped.
+*/
+class SnapshotWriter
+{
+public:
+    SnapshotWriter();
+    ~SnapshotWriter();
+
+    //  interval is the number of steps between two snapshots
+    bool Open(const std::string& path, int interval);
+    void Close();
+    bool IsOpen() const;
+
+    //  Called once per simulation step, captures every interval steps
+    void Capture(const ParticleData& particles, int count);
+    void Capture(const ParticleSystem& system);
+
+    int GetWrittenCount() const;
+    int GetDroppedCount() const;
+    bool HasFailed() const;
+
+private:
+    enum BufferState
+    {
+        BUFFER_FREE,
+        BUFFER_PENDING,
+        BUFFER_WRITING
+    };
+
+    struct Frame
+    {
+        BufferState state;
+        unsigned int step;
+        unsigned int count;
+        //  packed attribute arrays, 7 floats then the ids
+        std::vector<float> floats;
+        std::vector<int> pids;
+    };
+
+    std::ofstream m_file;
+    std::string m_path;
+    int m_interval;
+    unsigned int m_step;
+
+    Frame m_frames[2];
+    int m_written;
+    int m_dropped;
+    bool m_failed;
+
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_quit;
+
+    void CaptureParts(const ParticleData* const* parts, const int* counts, int partCount);
+    void WriterLoop();
+    bool WriteFrame(const Frame& frame);
+
+    SnapshotWriter(const SnapshotWriter&);
+    SnapshotWriter& operator=(const SnapshotWriter&);
+};
+
+#endif // !SNAPSHOT_WRITER_H
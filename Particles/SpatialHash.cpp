@@ -0,0 +1,156 @@
+/*
+    Implementation of SPATIAL_HASH_H
+*/
+
+#include "SpatialHash.h"
+#include <algorithm>
+
+//  Buckets per block of the parallel prefix sum
+const int HASH_SCAN_BLOCK = 4096;
+
+SpatialHash::SpatialHash() :
+    m_cellSize(1.0f), m_invCellSize(1.0f), m_tableMask(0), m_cursor(NULL), m_cursorCapacity(0)
+{
+}
+
+SpatialHash::~SpatialHash()
+{
+    delete[] m_cursor;
+}
+
+void SpatialHash::SetCellSize(float cellSize)
+{
+    m_cellSize = cellSize;
+    m_invCellSize = 1.0f / cellSize;
+}
+
+float SpatialHash::GetCellSize() const
+{
+    return m_cellSize;
+}
+
+/*
+    Sizes the tables for count particles, about two buckets per particle
+*/
+void SpatialHash::Resize(int count)
+{
+    int buckets = 1024;
+    while (buckets < 2 * count)
+        buckets *= 2;
+    m_tableMask = buckets - 1;
+
+    m_bucketOf.resize(count);
+    m_cellX.resize(count);
+    m_cellY.resize(count);
+    m_cellZ.resize(count);
+    m_sorted.resize(count);
+    m_cellStart.resize(buckets);
+    m_cellEnd.resize(buckets);
+    m_blockSums.resize((buckets + HASH_SCAN_BLOCK - 1) / HASH_SCAN_BLOCK);
+
+    if (buckets > m_cursorCapacity)
+    {
+        delete[] m_cursor;
+        m_cursor = new std::atomic<int>[buckets];
+        m_cursorCapacity = buckets;
+    }
+}
+
+void SpatialHash::Build(const float* x, const float* y, const float* z, int count, ThreadPool* pool)
+{
+    Resize(count);
+    int buckets = m_tableMask + 1;
+
+    //  Runs task over [0, n), on the pool when there is one
+    auto parallelFor = [pool](int n, int chunk, const std::function<void(int, int)>& task) {
+        if (pool != NULL)
+            pool->ParallelFor(n, chunk, task);
+        else if (n > 0)
+            task(0, n);
+    };
+
+    //  1. clear the counts
+    parallelFor(buckets, HASH_SCAN_BLOCK, [this](int begin, int end) {
+        for (int b = begin; b < end; b++)
+            m_cursor[b].store(0, std::memory_order_relaxed);
+    });
+
+    //  2. cell and bucket of every particle and bucket sizes
+    parallelFor(count, 2048, [&](int begin, int end) {
+        for (int i = begin; i < end; i++)
+        {
+            m_cellX[i] = Cell(x[i]);
+            m_cellY[i] = Cell(y[i]);
+            m_cellZ[i] = Cell(z[i]);
+
+            int b = Bucket(m_cellX[i], m_cellY[i], m_cellZ[i]);
+            m_bucketOf[i] = b;
+            m_cursor[b].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    //  3. exclusive prefix sum of the sizes into the start table,
+    //  sum per block, scan the block sums, then scan inside every block
+    parallelFor(buckets, HASH_SCAN_BLOCK, [this](int begin, int end) {
+        int sum = 0;
+        for (int b = begin; b < end; b++)
+            sum += m_cursor[b].load(std::memory_order_relaxed);
+        m_blockSums[begin / HASH_SCAN_BLOCK] = sum;
+    });
+
+    int offset = 0;
+    for (size_t k = 0; k < m_blockSums.size(); k++)
+    {
+        int sum = m_blockSums[k];
+        m_blockSums[k] = offset;
+        offset += sum;
+    }
+
+    parallelFor(buckets, HASH_SCAN_BLOCK, [this](int begin, int end) {
+        int start = m_blockSums[begin / HASH_SCAN_BLOCK];
+        for (int b = begin; b < end; b++)
+        {
+            int size = m_cursor[b].load(std::memory_order_relaxed);
+            m_cellStart[b] = start;
+            m_cellEnd[b] = start + size;
+            m_cursor[b].store(start, std::memory_order_relaxed);
+            start += size;
+        }
+    });
+
+    //  4. scatter the particle indices
+    parallelFor(count, 2048, [this](int begin, int end) {
+        for (int i = begin; i < end; i++)
+            m_sorted[m_cursor[m_bucketOf[i]].fetch_add(1, std::memory_order_relaxed)] = i;
+    });
+
+    //  5. the scatter order depends on the thread timing, restore index order
+    //  inside every bucket; buckets hold a handful of particles
+    parallelFor(buckets, HASH_SCAN_BLOCK, [this](int begin, int end) {
+        for (int b = begin; b < end; b++)
+        {
+            if (m_cellEnd[b] - m_cellStart[b] > 1)
+                std::sort(m_sorted.begin() + m_cellStart[b], m_sorted.begin() + m_cellEnd[b]);
+        }
+    });
+}
+
+int SpatialHash::GetBucketCount() const
+{
+    return m_tableMask + 1;
+}
+
+const int* SpatialHash::GetCellStart() const
+{
+    return m_cellStart.empty() ? NULL : &m_cellStart[0];
+}
+
+const int* SpatialHash::GetCellEnd() const
+{
+    return m_cellEnd.empty() ? NULL : &m_cellEnd[0];
+}
+
+const int* SpatialHash::GetSortedIndices() const
+{
+    return m_sorted.empty() ? NULL : &m_sorted[0];
+}
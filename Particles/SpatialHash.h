@@ -0,0 +1,113 @@
+#pragma once
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+/*
+    Uniform grid over hashed cells for neighbour queries between particles
+
+    Build sorts the particle indices by cell with a counting sort:
+    count per bucket, prefix sum into the bucket start table, scatter.
+    All three passes are linear and run on the thread pool; the particles of
+    a bucket are finally put back in index order so queries visit
+    neighbours in the same order whatever the thread count.
+
+    With the cell size at least the interaction distance, every neighbour of
+    a particle lies in one of the 27 cells around it. Several cells can share
+    a bucket, so queries compare the stored cell of every candidate against
+    the cell they are looking at.
+*/
+class SpatialHash
+{
+public:
+    SpatialHash();
+    ~SpatialHash();
+
+    void SetCellSize(float cellSize);
+    float GetCellSize() const;
+
+    //  Rebuilds the grid from positions [0, count), pool may be NULL
+    void Build(const float* x, const float* y, const float* z, int count, ThreadPool* pool);
+
+    //  Calls visit(j) once for every particle j in the 27 cells around (px, py, pz)
+    template<class Visitor>
+    void ForEachNeighbor(float px, float py, float pz, Visitor visit) const;
+
+    //  Bucket tables, particles of bucket b are m_sorted[m_cellStart[b] .. m_cellEnd[b])
+    int GetBucketCount() const;
+    const int* GetCellStart() const;
+    const int* GetCellEnd() const;
+    const int* GetSortedIndices() const;
+
+private:
+    float m_cellSize;
+    float m_invCellSize;
+    int m_tableMask;
+
+    std::vector<int> m_bucketOf;        //  per particle
+    std::vector<int> m_cellX;           //  per particle, integer cell coordinates
+    std::vector<int> m_cellY;
+    std::vector<int> m_cellZ;
+    std::vector<int> m_sorted;          //  particle indices grouped by bucket
+    std::vector<int> m_cellStart;       //  per bucket
+    std::vector<int> m_cellEnd;         //  per bucket
+    std::vector<int> m_blockSums;       //  prefix sum scratch, per block of buckets
+
+    std::atomic<int>* m_cursor;         //  per bucket, count then scatter position
+    int m_cursorCapacity;
+
+    int Cell(float v) const;
+    int Bucket(int cx, int cy, int cz) const;
+    void Resize(int count);
+
+    SpatialHash(const SpatialHash&);
+    SpatialHash& operator=(const SpatialHash&);
+};
+
+inline int SpatialHash::Cell(float v) const
+{
+    return (int)std::floor(v * m_invCellSize);
+}
+
+inline int SpatialHash::Bucket(int cx, int cy, int cz) const
+{
+    unsigned int h = ((unsigned int)cx * 73856093u) ^ ((unsigned int)cy * 19349663u) ^ ((unsigned int)cz * 83492791u);
+    return (int)(h & (unsigned int)m_tableMask);
+}
+
+template<class Visitor>
+void SpatialHash::ForEachNeighbor(float px, float py, float pz, Visitor visit) const
+{
+    int cx = Cell(px);
+    int cy = Cell(py);
+    int cz = Cell(pz);
+
+    for (int dz = -1; dz <= 1; dz++)
+    {
+        for (int dy = -1; dy <= 1; dy++)
+        {
+            for (int dx = -1; dx <= 1; dx++)
+            {
+                int nx = cx + dx;
+                int ny = cy + dy;
+                int nz = cz + dz;
+                int b = Bucket(nx, ny, nz);
+
+                for (int s = m_cellStart[b]; s < m_cellEnd[b]; s++)
+                {
+                    //  skip particles of other cells hashed to the same bucket
+                    int j = m_sorted[s];
+                    if (m_cellX[j] == nx && m_cellY[j] == ny && m_cellZ[j] == nz)
+                        visit(j);
+                }
+            }
+        }
+    }
+}
+
+#endif // !SPATIAL_HASH_H
@@ -17,14 +17,16 @@ public:
     GLenum m_texType, m_texInternalFormat,m_texFormat;
     std::string m_name;
 
-    Texture()
+    Texture() : m_texID(0)
     {
 
     }
 
     ~Texture()
     {
-        glDeleteTextures(1, &this->m_texID);
+        //  nothing to delete if no texture was ever loaded (e.g. no GL context)
+        if (this->m_texID != 0)
+            glDeleteTextures(1, &this->m_texID);
     }
     
     GLuint LoadTexture(GLchar* path, std::string name);
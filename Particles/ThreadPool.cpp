@@ -0,0 +1,168 @@
+/*
+    Implementation of THREAD_POOL_H
+*/
+
+#include "ThreadPool.h"
+#include "Profiler.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threadCount) :
+    m_queues(NULL), m_threadCount(0), m_task(NULL), m_count(0), m_chunkSize(1), m_generation(0), m_busyWorkers(0), m_quit(false)
+{
+    SetThreadCount(threadCount);
+}
+
+ThreadPool::~ThreadPool()
+{
+    StopWorkers();
+    delete[] m_queues;
+}
+
+void ThreadPool::SetThreadCount(int threadCount)
+{
+    if (threadCount <= 0)
+        threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+    if (threadCount == m_threadCount)
+        return;
+
+    StopWorkers();
+    delete[] m_queues;
+
+    m_threadCount = threadCount;
+    m_queues = new ChunkQueue[m_threadCount];
+    StartWorkers();
+}
+
+int ThreadPool::GetThreadCount() const
+{
+    return m_threadCount;
+}
+
+void ThreadPool::StartWorkers()
+{
+    unsigned int generation;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = false;
+        generation = m_generation;
+    }
+    //  participant 0 is always the thread calling ParallelFor
+    //  new workers start at the current generation so a resize does not
+    //  look like a job to them
+    for (int i = 1; i < m_threadCount; i++)
+        m_workers.push_back(std::thread(&ThreadPool::WorkerLoop, this, i, generation));
+}
+
+void ThreadPool::StopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    for (size_t i = 0; i < m_workers.size(); i++)
+        m_workers[i].join();
+    m_workers.clear();
+}
+
+void ThreadPool::ParallelFor(int count, int chunkSize, const std::function<void(int, int)>& task)
+{
+    if (count <= 0)
+        return;
+    if (chunkSize < 1)
+        chunkSize = 1;
+
+    int chunks = (count + chunkSize - 1) / chunkSize;
+
+    //  Not worth waking anybody up
+    if (m_threadCount == 1 || chunks == 1)
+    {
+        for (int begin = 0; begin < count; begin += chunkSize)
+            task(begin, std::min(begin + chunkSize, count));
+        return;
+    }
+
+    //  Deal every participant a contiguous run of chunks
+    for (int i = 0; i < m_threadCount; i++)
+    {
+        m_queues[i].next.store((int)((long long)chunks * i / m_threadCount), std::memory_order_relaxed);
+        m_queues[i].end = (int)((long long)chunks * (i + 1) / m_threadCount);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_count = count;
+        m_chunkSize = chunkSize;
+        m_busyWorkers = (int)m_workers.size();
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    RunChunks(0);
+
+    //  Every chunk has been claimed, wait for the workers still running theirs
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_busyWorkers == 0; });
+    m_task = NULL;
+}
+
+void ThreadPool::WorkerLoop(int self, unsigned int generation)
+{
+    PROFILE_THREAD("Worker");
+    unsigned int seen = generation;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_quit || m_generation != seen; });
+            if (m_quit)
+                return;
+            seen = m_generation;
+        }
+
+        RunChunks(self);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_busyWorkers--;
+        }
+        m_done.notify_one();
+    }
+}
+
+/*
+    Drains the participant's own queue, then steals from the others
+*/
+void ThreadPool::RunChunks(int self)
+{
+    PROFILE_SCOPE("ThreadPool::RunChunks");
+    while (RunChunk(self))
+        ;
+
+    for (int offset = 1; offset < m_threadCount; offset++)
+    {
+        int victim = (self + offset) % m_threadCount;
+        while (RunChunk(victim))
+            ;
+    }
+}
+
+/*
+    Claims the next chunk of a queue and runs it, returns false once the queue is empty
+*/
+bool ThreadPool::RunChunk(int queue)
+{
+    ChunkQueue& q = m_queues[queue];
+    if (q.next.load(std::memory_order_relaxed) >= q.end)
+        return false;
+
+    int chunk = q.next.fetch_add(1);
+    if (chunk >= q.end)
+        return false;
+
+    int begin = chunk * m_chunkSize;
+    int end = std::min(begin + m_chunkSize, m_count);
+    (*m_task)(begin, end);
+    return true;
+}
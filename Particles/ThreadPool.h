@@ -0,0 +1,74 @@
+#pragma once
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+    Persistent pool of worker threads running chunked parallel loops
+
+    ParallelFor splits [0, count) into chunks and deals every participant
+    (the workers plus the calling thread) a contiguous run of chunks.
+    A participant that runs out of its own chunks steals from the others,
+    so uneven chunk costs do not leave threads idle.
+    Each chunk is always executed exactly once, so as long as the task only
+    writes to the elements of its own range the result is independent of
+    the thread count.
+*/
+class ThreadPool
+{
+public:
+    //  threadCount includes the calling thread, 0 uses one thread per core
+    explicit ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+
+    void SetThreadCount(int threadCount);
+    int GetThreadCount() const;
+
+    //  Runs task(begin, end) over [0, count) in chunks of chunkSize and blocks until done
+    void ParallelFor(int count, int chunkSize, const std::function<void(int, int)>& task);
+
+private:
+    //  one per participant, padded to its own cache line
+    struct ChunkQueue
+    {
+        std::atomic<int> next;
+        int end;
+        char padding[64 - sizeof(std::atomic<int>) - sizeof(int)];
+
+        ChunkQueue() : next(0), end(0) {}
+    };
+
+    std::vector<std::thread> m_workers;
+    ChunkQueue* m_queues;
+    int m_threadCount;
+
+    //  current job
+    const std::function<void(int, int)>* m_task;
+    int m_count;
+    int m_chunkSize;
+
+    //  job hand-off between the caller and the workers
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+    unsigned int m_generation;
+    int m_busyWorkers;
+    bool m_quit;
+
+    void StartWorkers();
+    void StopWorkers();
+    void WorkerLoop(int self, unsigned int generation);
+    void RunChunks(int self);
+    bool RunChunk(int queue);
+
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+};
+
+#endif // !THREAD_POOL_H